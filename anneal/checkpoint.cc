@@ -0,0 +1,222 @@
+#include "checkpoint.h"
+
+#include <iostream>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace anneal {
+
+static const char kMagic[4] = {'A', 'N', 'C', 'K'};
+static const uint32_t kVersion = 3;
+
+Checkpointer::Checkpointer(const std::string &path, uint64_t fingerprint,
+                           size_t num_slots, size_t payload_size)
+    : path_(path),
+      fingerprint_(fingerprint),
+      num_slots_(num_slots),
+      payload_size_(payload_size),
+      slots_(new Slot[num_slots]),
+      num_attempts_(0),
+      remaining_attempts_(0),
+      generation_(0),
+      stopping_(false) {
+  for (size_t i = 0; i < num_slots_; i++) {
+    slots_[i].payload.reset(new char[payload_size_]());
+  }
+}
+
+Checkpointer::~Checkpointer() { Stop(); }
+
+void Checkpointer::Start(std::chrono::seconds interval) {
+  writer_ = std::thread([this, interval]() {
+    std::unique_lock<std::mutex> lock(writer_mutex_);
+    while (!writer_cv_.wait_for(lock, interval, [this] { return stopping_; })) {
+      Write();
+      generation_++;
+    }
+  });
+}
+
+void Checkpointer::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    stopping_ = true;
+  }
+  writer_cv_.notify_all();
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+}
+
+bool Checkpointer::SnapshotDue(uint64_t *seen_generation) const {
+  uint64_t generation = generation_.load(std::memory_order_relaxed);
+  if (generation == *seen_generation) {
+    return false;
+  }
+  *seen_generation = generation;
+  return true;
+}
+
+void Checkpointer::Copy(Slot *slot, const void *payload) {
+  memcpy(slot->payload.get(), payload, payload_size_);
+  slot->state = SlotState::Live;
+}
+
+void Checkpointer::Begin(size_t slot, int64_t attempt) {
+  std::lock_guard<std::mutex> lock(slots_[slot].mutex);
+  slots_[slot].state = SlotState::Started;
+  slots_[slot].attempt = attempt;
+}
+
+bool Checkpointer::TryPublish(size_t slot, const void *payload) {
+  std::unique_lock<std::mutex> lock(slots_[slot].mutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return false;
+  }
+  Copy(&slots_[slot], payload);
+  return true;
+}
+
+void Checkpointer::Publish(size_t slot, const void *payload) {
+  std::lock_guard<std::mutex> lock(slots_[slot].mutex);
+  Copy(&slots_[slot], payload);
+}
+
+void Checkpointer::Clear(size_t slot) {
+  std::lock_guard<std::mutex> lock(slots_[slot].mutex);
+  slots_[slot].state = SlotState::Empty;
+}
+
+bool Checkpointer::Write() {
+  const size_t slot_size = sizeof(CheckpointSlotHeader) + payload_size_;
+  std::vector<char> buffer(sizeof(CheckpointHeader) + num_slots_ * slot_size);
+
+  CheckpointHeader header;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.fingerprint = fingerprint_;
+  header.num_slots = num_slots_;
+  header.slot_size = slot_size;
+  header.num_attempts = num_attempts_;
+  header.remaining_attempts = remaining_attempts_;
+  memcpy(buffer.data(), &header, sizeof(header));
+
+  for (size_t i = 0; i < num_slots_; i++) {
+    char *dest = buffer.data() + sizeof(CheckpointHeader) + i * slot_size;
+    std::lock_guard<std::mutex> lock(slots_[i].mutex);
+    CheckpointSlotHeader slot_header = {slots_[i].state, 0, slots_[i].attempt};
+    if (slots_[i].state == SlotState::Live) {
+      memcpy(dest + sizeof(slot_header), slots_[i].payload.get(),
+             payload_size_);
+    }
+    memcpy(dest, &slot_header, sizeof(slot_header));
+  }
+
+  std::string tmp_path = path_ + ".tmp";
+  int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    std::cerr << "Cannot open " << tmp_path << ": " << strerror(errno)
+              << std::endl;
+    return false;
+  }
+  size_t written = 0;
+  while (written < buffer.size()) {
+    ssize_t result =
+        write(fd, buffer.data() + written, buffer.size() - written);
+    if (result < 0) {
+      std::cerr << "Cannot write " << tmp_path << ": " << strerror(errno)
+                << std::endl;
+      close(fd);
+      return false;
+    }
+    written += result;
+  }
+  fsync(fd);
+  close(fd);
+
+  if (rename(tmp_path.c_str(), path_.c_str()) != 0) {
+    std::cerr << "Cannot rename " << tmp_path << ": " << strerror(errno)
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool Checkpointer::Remove() { return unlink(path_.c_str()) == 0; }
+
+/* static */
+uint64_t Checkpointer::Fingerprint(const std::string &config) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : config) {
+    hash = (hash ^ (unsigned char)c) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+/* static */
+std::unique_ptr<CheckpointReader> CheckpointReader::Open(
+    const std::string &path, uint64_t fingerprint, size_t payload_size) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "Cannot open " << path << ": " << strerror(errno)
+              << std::endl;
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CheckpointHeader)) {
+    std::cerr << path << " is not a checkpoint" << std::endl;
+    close(fd);
+    return nullptr;
+  }
+  void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    std::cerr << "Cannot map " << path << ": " << strerror(errno) << std::endl;
+    return nullptr;
+  }
+
+  std::unique_ptr<CheckpointReader> reader(
+      new CheckpointReader(data, st.st_size));
+  const CheckpointHeader &header = *reader->header_;
+  const size_t slot_size = sizeof(CheckpointSlotHeader) + payload_size;
+  if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion) {
+    std::cerr << path << " is not a valid checkpoint" << std::endl;
+    return nullptr;
+  }
+  if (header.fingerprint != fingerprint) {
+    std::cerr << path << " was written with a different configuration"
+              << std::endl;
+    return nullptr;
+  }
+  if (header.slot_size != slot_size ||
+      sizeof(CheckpointHeader) + header.num_slots * slot_size >
+          (size_t)st.st_size) {
+    std::cerr << path << " is truncated or corrupt" << std::endl;
+    return nullptr;
+  }
+  return reader;
+}
+
+CheckpointReader::CheckpointReader(const void *data, size_t size)
+    : data_(data),
+      size_(size),
+      header_(static_cast<const CheckpointHeader *>(data)) {}
+
+CheckpointReader::~CheckpointReader() {
+  munmap(const_cast<void *>(data_), size_);
+}
+
+const void *CheckpointReader::payload(size_t slot) const {
+  const CheckpointSlotHeader *header = slot_header(slot);
+  return header->state == SlotState::Live ? header + 1 : nullptr;
+}
+
+}  // namespace anneal
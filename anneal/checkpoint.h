@@ -0,0 +1,160 @@
+#ifndef ANNEAL_CHECKPOINT_H_
+#define ANNEAL_CHECKPOINT_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace anneal {
+
+// On-disk layout of a checkpoint: a Header followed by num_slots slots of
+// slot_size bytes each. Every slot starts with a SlotHeader; the rest of the
+// slot is an opaque payload owned by the solver. Attempts that have not been
+// started by any slot are counted by remaining_attempts; they are the last
+// ones of the num_attempts of the run.
+struct CheckpointHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t fingerprint;
+  uint32_t num_slots;
+  uint32_t slot_size;
+  int64_t num_attempts;
+  int64_t remaining_attempts;
+};
+
+enum class SlotState : uint32_t {
+  Empty,
+  // Holds an attempt that has not published a payload yet. It is restarted
+  // from scratch on resume.
+  Started,
+  // Holds an attempt and its payload.
+  Live,
+};
+
+struct CheckpointSlotHeader {
+  SlotState state;
+  uint32_t reserved;
+  int64_t attempt;
+};
+
+// Collects per-worker snapshots in memory and periodically writes them to
+// disk. Workers never block on the writer: periodic snapshots are skipped if
+// the writer happens to be copying the same slot, in which case the slot
+// keeps its previous payload.
+class Checkpointer {
+ public:
+  Checkpointer(const std::string &path, uint64_t fingerprint, size_t num_slots,
+               size_t payload_size);
+  ~Checkpointer();
+
+  // Starts a background thread that writes the checkpoint every interval.
+  void Start(std::chrono::seconds interval);
+  void Stop();
+
+  // Returns true once per writer interval, so workers only pay for a
+  // snapshot when the writer is going to use it.
+  bool SnapshotDue(uint64_t *seen_generation) const;
+
+  // Hands the slot to `attempt`, which is checkpointed as started until it
+  // publishes a payload.
+  void Begin(size_t slot, int64_t attempt);
+  // Copies payload_size bytes into the slot. TryPublish gives up if the slot
+  // is being written out; Publish waits for it.
+  bool TryPublish(size_t slot, const void *payload);
+  void Publish(size_t slot, const void *payload);
+  // Frees the slot once its attempt is over.
+  void Clear(size_t slot);
+
+  // Attempts not handed to a slot yet. Set after the slots of a wave have
+  // begun, so that a checkpoint in between at worst counts an attempt twice.
+  void set_remaining_attempts(int64_t remaining) {
+    remaining_attempts_ = remaining;
+  }
+  // Attempts of the whole run, so that a resumed run numbers the attempts
+  // it has yet to start as the original run would have.
+  void set_num_attempts(int64_t num_attempts) { num_attempts_ = num_attempts; }
+
+  // Writes the checkpoint to a temporary file and renames it over the
+  // target, so readers never see a partially written checkpoint.
+  bool Write();
+  bool Remove();
+
+  size_t num_slots() const { return num_slots_; }
+  size_t payload_size() const { return payload_size_; }
+
+  // FNV-1a hash of a description of the solver configuration. Resuming from
+  // a checkpoint taken with a different configuration is refused.
+  static uint64_t Fingerprint(const std::string &config);
+
+ private:
+  struct Slot {
+    std::mutex mutex;
+    SlotState state = SlotState::Empty;
+    int64_t attempt = 0;
+    std::unique_ptr<char[]> payload;
+  };
+
+  void Copy(Slot *slot, const void *payload);
+
+  const std::string path_;
+  const uint64_t fingerprint_;
+  const size_t num_slots_;
+  const size_t payload_size_;
+  std::unique_ptr<Slot[]> slots_;
+  int64_t num_attempts_;
+  std::atomic<int64_t> remaining_attempts_;
+  std::atomic<uint64_t> generation_;
+
+  std::mutex writer_mutex_;
+  std::condition_variable writer_cv_;
+  bool stopping_;
+  std::thread writer_;
+};
+
+// Read-only, memory-mapped view of a checkpoint written by Checkpointer.
+class CheckpointReader {
+ public:
+  // Returns nullptr (and reports why on stderr) if the file cannot be mapped
+  // or does not match the expected fingerprint and payload size.
+  static std::unique_ptr<CheckpointReader> Open(const std::string &path,
+                                                uint64_t fingerprint,
+                                                size_t payload_size);
+  ~CheckpointReader();
+
+  size_t num_slots() const { return header_->num_slots; }
+  int64_t num_attempts() const { return header_->num_attempts; }
+  int64_t remaining_attempts() const { return header_->remaining_attempts; }
+
+  // Whether the slot holds an attempt, and which one.
+  bool has_attempt(size_t slot) const {
+    return slot_header(slot)->state != SlotState::Empty;
+  }
+  int64_t attempt(size_t slot) const { return slot_header(slot)->attempt; }
+  // Returns the payload of a slot, or nullptr if its attempt has to start
+  // over or the slot holds none.
+  const void *payload(size_t slot) const;
+
+ private:
+  CheckpointReader(const void *data, size_t size);
+
+  const CheckpointSlotHeader *slot_header(size_t slot) const {
+    return reinterpret_cast<const CheckpointSlotHeader *>(
+        static_cast<const char *>(data_) + sizeof(CheckpointHeader) +
+        slot * header_->slot_size);
+  }
+
+  const void *data_;
+  size_t size_;
+  const CheckpointHeader *header_;
+};
+
+}  // namespace anneal
+
+#endif  // ANNEAL_CHECKPOINT_H_
@@ -0,0 +1,79 @@
+#include "checkpoint.h"
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+
+using anneal::Checkpointer;
+using anneal::CheckpointReader;
+
+static std::string TempPath() {
+  const char *dir = getenv("TEST_TMPDIR");
+  return std::string(dir != nullptr ? dir : "/tmp") + "/checkpoint_test.ckpt";
+}
+
+TEST(CheckpointTest, RoundTrip) {
+  uint64_t fingerprint = Checkpointer::Fingerprint("board_size=4");
+  Checkpointer checkpointer(TempPath(), fingerprint, 3, sizeof(uint64_t));
+  checkpointer.set_num_attempts(30);
+  checkpointer.set_remaining_attempts(17);
+
+  uint64_t first = 0x0123456789abcdefULL;
+  uint64_t second = 42;
+  checkpointer.Begin(0, 5);
+  EXPECT_TRUE(checkpointer.TryPublish(0, &first));
+  checkpointer.Begin(2, 7);
+  checkpointer.Publish(2, &second);
+  checkpointer.Begin(1, 6);
+  checkpointer.Publish(1, &second);
+  checkpointer.Clear(1);
+  ASSERT_TRUE(checkpointer.Write());
+
+  auto reader = CheckpointReader::Open(TempPath(), fingerprint,
+                                       sizeof(uint64_t));
+  ASSERT_TRUE(reader != nullptr);
+  EXPECT_EQ(3UL, reader->num_slots());
+  EXPECT_EQ(30, reader->num_attempts());
+  EXPECT_EQ(17, reader->remaining_attempts());
+  ASSERT_TRUE(reader->has_attempt(0));
+  EXPECT_EQ(5, reader->attempt(0));
+  EXPECT_EQ(first, *static_cast<const uint64_t *>(reader->payload(0)));
+  EXPECT_FALSE(reader->has_attempt(1));
+  EXPECT_TRUE(reader->payload(1) == nullptr);
+  ASSERT_TRUE(reader->has_attempt(2));
+  EXPECT_EQ(7, reader->attempt(2));
+  EXPECT_EQ(second, *static_cast<const uint64_t *>(reader->payload(2)));
+  EXPECT_TRUE(checkpointer.Remove());
+}
+
+TEST(CheckpointTest, KeepsAttemptsThatHaveNotPublished) {
+  Checkpointer checkpointer(TempPath(), 0, 2, sizeof(uint64_t));
+  checkpointer.Begin(1, 3);
+  ASSERT_TRUE(checkpointer.Write());
+
+  auto reader = CheckpointReader::Open(TempPath(), 0, sizeof(uint64_t));
+  ASSERT_TRUE(reader != nullptr);
+  EXPECT_FALSE(reader->has_attempt(0));
+  // Started over on resume.
+  ASSERT_TRUE(reader->has_attempt(1));
+  EXPECT_EQ(3, reader->attempt(1));
+  EXPECT_TRUE(reader->payload(1) == nullptr);
+  EXPECT_TRUE(checkpointer.Remove());
+}
+
+TEST(CheckpointTest, RejectsOtherConfiguration) {
+  Checkpointer checkpointer(TempPath(), Checkpointer::Fingerprint("a"), 1, 8);
+  ASSERT_TRUE(checkpointer.Write());
+
+  EXPECT_TRUE(CheckpointReader::Open(TempPath(), Checkpointer::Fingerprint("b"),
+                                     8) == nullptr);
+  EXPECT_TRUE(CheckpointReader::Open(TempPath(), Checkpointer::Fingerprint("a"),
+                                     16) == nullptr);
+  EXPECT_TRUE(checkpointer.Remove());
+}
+
+TEST(CheckpointTest, SnapshotDueOncePerGeneration) {
+  Checkpointer checkpointer(TempPath(), 0, 1, 8);
+  uint64_t seen = ~0ULL;
+  EXPECT_TRUE(checkpointer.SnapshotDue(&seen));
+  EXPECT_FALSE(checkpointer.SnapshotDue(&seen));
+}
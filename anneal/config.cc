@@ -0,0 +1,74 @@
+#include "config.h"
+
+#include <iostream>
+#include <sstream>
+
+#include <stdlib.h>
+
+namespace anneal {
+
+bool ParseScheduleKind(const std::string &name, ScheduleKind *kind) {
+  if (name == "geometric") {
+    *kind = ScheduleKind::Geometric;
+  } else if (name == "adaptive") {
+    *kind = ScheduleKind::Adaptive;
+  } else {
+    std::cerr << "Unknown schedule '" << name << "'" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+const char *ScheduleKindName(ScheduleKind kind) {
+  return kind == ScheduleKind::Adaptive ? "adaptive" : "geometric";
+}
+
+/* static */
+bool SolverConfig::Parse(const std::string &spec, SolverConfig *config) {
+  std::istringstream fields(spec);
+  std::string field;
+  while (std::getline(fields, field, ',')) {
+    if (field.empty()) {
+      continue;
+    }
+    size_t eq = field.find('=');
+    if (eq == std::string::npos) {
+      std::cerr << "Expected key=value, got '" << field << "'" << std::endl;
+      return false;
+    }
+    std::string key = field.substr(0, eq);
+    const char *value = field.c_str() + eq + 1;
+    if (key == "max_tries") {
+      config->max_tries = atoll(value);
+    } else if (key == "annealing_steps") {
+      config->annealing_steps = atoi(value);
+    } else if (key == "t_max") {
+      config->t_max = atof(value);
+    } else if (key == "t_min") {
+      config->t_min = atof(value);
+    } else if (key == "schedule") {
+      if (!ParseScheduleKind(value, &config->schedule)) {
+        return false;
+      }
+    } else if (key == "max_reheats") {
+      config->max_reheats = atoi(value);
+    } else {
+      std::cerr << "Unknown solver parameter '" << key << "'" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string SolverConfig::ToString() const {
+  std::ostringstream os;
+  os << "max_tries=" << max_tries << ",annealing_steps=" << annealing_steps
+     << ",t_max=" << t_max << ",t_min=" << t_min
+     << ",schedule=" << ScheduleKindName(schedule);
+  if (schedule == ScheduleKind::Adaptive) {
+    os << ",max_reheats=" << max_reheats;
+  }
+  return os.str();
+}
+
+}  // namespace anneal
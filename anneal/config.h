@@ -0,0 +1,44 @@
+#ifndef ANNEAL_CONFIG_H_
+#define ANNEAL_CONFIG_H_
+
+#include <string>
+
+#include <math.h>
+#include <stdint.h>
+
+#include "schedule.h"
+
+namespace anneal {
+
+// Parses "geometric" or "adaptive".
+bool ParseScheduleKind(const std::string &name, ScheduleKind *kind);
+const char *ScheduleKindName(ScheduleKind kind);
+
+// Parameters of the annealing schedule of a single attempt.
+struct SolverConfig {
+  int64_t max_tries = 24;
+  int32_t annealing_steps = 200;
+  double t_max = 1.0;
+  double t_min = 0.00001;
+  ScheduleKind schedule = ScheduleKind::Geometric;
+  // Only used by the adaptive schedule.
+  int32_t max_reheats = 4;
+
+  // Ratio between the temperatures of consecutive stages.
+  double alpha() const { return exp(log(t_min / t_max) / annealing_steps); }
+
+  // Parses "key=value" pairs separated by commas, e.g.
+  // "max_tries=24,annealing_steps=200,schedule=adaptive". Unknown keys are an
+  // error.
+  static bool Parse(const std::string &spec, SolverConfig *config);
+  std::string ToString() const;
+
+  CoolingSchedule NewSchedule() const {
+    return CoolingSchedule(schedule, t_max, t_min, annealing_steps, max_tries,
+                           max_reheats);
+  }
+};
+
+}  // namespace anneal
+
+#endif  // ANNEAL_CONFIG_H_
@@ -0,0 +1,503 @@
+#include "coordinator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace anneal {
+
+// How often the coordinator checks for a solution found by a process that
+// only told the shared memory so far.
+static const int kPollMilliseconds = 10;
+// How long workers get to report their final progress once the run is over.
+static const int kDrainMilliseconds = 1000;
+
+// Addresses without a '/' but with a ':' are host:port TCP addresses; any
+// other is the path of a Unix domain socket.
+static bool IsTcpAddress(const std::string &address) {
+  return address.find('/') == std::string::npos &&
+         address.rfind(':') != std::string::npos;
+}
+
+static bool MakeAddress(const std::string &path, struct sockaddr_un *addr) {
+  memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr->sun_path)) {
+    std::cerr << "Socket path too long: " << path << std::endl;
+    return false;
+  }
+  memcpy(addr->sun_path, path.c_str(), path.size());
+  return true;
+}
+
+// Resolves a host:port address. An empty host stands for every interface
+// when listening, and for this host when connecting.
+static struct addrinfo *Resolve(const std::string &address, bool listening) {
+  size_t colon = address.rfind(':');
+  std::string host = address.substr(0, colon);
+  std::string port = address.substr(colon + 1);
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = listening ? AI_PASSIVE : 0;
+  struct addrinfo *addrs = nullptr;
+  int error = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(),
+                          &hints, &addrs);
+  if (error != 0) {
+    std::cerr << "Could not resolve " << address << ": "
+              << gai_strerror(error) << std::endl;
+    return nullptr;
+  }
+  return addrs;
+}
+
+// Opens a socket listening on, or connected to, `address`. Returns -1 with
+// errno set on error.
+static int OpenSocket(const std::string &address, bool listening) {
+  if (!IsTcpAddress(address)) {
+    struct sockaddr_un addr;
+    if (!MakeAddress(address, &addr)) {
+      errno = ENAMETOOLONG;
+      return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+      return -1;
+    }
+    bool ok;
+    if (listening) {
+      unlink(address.c_str());
+      ok = bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0 &&
+           listen(fd, SOMAXCONN) == 0;
+    } else {
+      ok = connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+    }
+    if (!ok) {
+      int error = errno;
+      close(fd);
+      errno = error;
+      return -1;
+    }
+    return fd;
+  }
+
+  struct addrinfo *addrs = Resolve(address, listening);
+  if (addrs == nullptr) {
+    errno = EINVAL;
+    return -1;
+  }
+  int fd = -1;
+  for (struct addrinfo *ai = addrs; ai != nullptr && fd < 0; ai = ai->ai_next) {
+    fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0) {
+      continue;
+    }
+    int one = 1;
+    bool ok;
+    if (listening) {
+      setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+      ok = bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 &&
+           listen(fd, SOMAXCONN) == 0;
+    } else {
+      ok = connect(fd, ai->ai_addr, ai->ai_addrlen) == 0;
+      // Every request waits for its reply.
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    if (!ok) {
+      int error = errno;
+      close(fd);
+      fd = -1;
+      errno = error;
+    }
+  }
+  freeaddrinfo(addrs);
+  return fd;
+}
+
+// Tells hosts apart, so that only workers on the coordinator's host attach
+// to its shared memory. The boot id is unique per host and boot; the host
+// name stands in where it cannot be read.
+static std::string HostId() {
+  std::string id;
+  std::ifstream boot_id("/proc/sys/kernel/random/boot_id");
+  if (!(boot_id >> id)) {
+    char name[256] = {0};
+    gethostname(name, sizeof(name) - 1);
+    id = name;
+  }
+  return id;
+}
+
+static bool SendLine(int fd, const std::string &line) {
+  std::string data = line + "\n";
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(fd, data.data() + sent, data.size() - sent,
+                     MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    sent += n;
+  }
+  return true;
+}
+
+// Moves the first complete line of *buffer into *line.
+static bool TakeLine(std::string *buffer, std::string *line) {
+  size_t end = buffer->find('\n');
+  if (end == std::string::npos) {
+    return false;
+  }
+  *line = buffer->substr(0, end);
+  buffer->erase(0, end + 1);
+  return true;
+}
+
+// Appends whatever can be read from fd to *buffer. Returns false once the
+// peer has gone away.
+static bool Receive(int fd, std::string *buffer) {
+  char data[4096];
+  ssize_t n;
+  do {
+    n = recv(fd, data, sizeof(data), 0);
+  } while (n < 0 && errno == EINTR);
+  if (n <= 0) {
+    return false;
+  }
+  buffer->append(data, n);
+  return true;
+}
+
+static bool ParseProgress(std::istringstream &fields,
+                          SharedRun::Counters *progress) {
+  return static_cast<bool>(fields >> progress->attempts >>
+                           progress->accepted >> progress->rejected);
+}
+
+static std::string FormatProgress(const SharedRun::Counters &progress) {
+  std::ostringstream os;
+  os << progress.attempts << " " << progress.accepted << " "
+     << progress.rejected;
+  return os.str();
+}
+
+Coordinator::Coordinator(SharedRun *run, const std::string &shm_name,
+                         uint64_t fingerprint, uint64_t seed,
+                         int64_t num_attempts, int64_t lease_size)
+    : run_(run),
+      shm_name_(shm_name),
+      fingerprint_(fingerprint),
+      seed_(seed),
+      num_attempts_(num_attempts),
+      lease_size_(lease_size),
+      listen_fd_(-1),
+      next_attempt_(0) {}
+
+Coordinator::~Coordinator() {
+  for (size_t i = workers_.size(); i > 0; i--) {
+    Drop(i - 1);
+  }
+  if (listen_fd_ >= 0) {
+    close(listen_fd_);
+    if (!IsTcpAddress(address_)) {
+      unlink(address_.c_str());
+    }
+  }
+}
+
+bool Coordinator::Listen(const std::string &address) {
+  listen_fd_ = OpenSocket(address, true);
+  if (listen_fd_ < 0) {
+    std::cerr << "Could not listen on " << address << ": " << strerror(errno)
+              << std::endl;
+    return false;
+  }
+  address_ = address;
+  if (IsTcpAddress(address)) {
+    // Report the port the kernel picked if asked for port 0.
+    struct sockaddr_storage bound;
+    socklen_t size = sizeof(bound);
+    char port[NI_MAXSERV];
+    if (getsockname(listen_fd_, (struct sockaddr *)&bound, &size) == 0 &&
+        getnameinfo((struct sockaddr *)&bound, size, nullptr, 0, port,
+                    sizeof(port), NI_NUMERICSERV) == 0) {
+      address_ = address.substr(0, address.rfind(':') + 1) + port;
+    }
+  }
+  return true;
+}
+
+bool Coordinator::done() const {
+  if (next_attempt_ < num_attempts_ || !returned_.empty()) {
+    return false;
+  }
+  for (const auto &worker : workers_) {
+    if (worker.has_lease) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Coordinator::Drop(size_t index) {
+  Worker &worker = workers_[index];
+  if (worker.has_lease) {
+    returned_.push_back(worker.lease);
+  }
+  close(worker.fd);
+  workers_.erase(workers_.begin() + index);
+}
+
+bool Coordinator::Handle(Worker *worker, const std::string &line) {
+  std::istringstream fields(line);
+  std::string command;
+  fields >> command;
+  if (!worker->welcomed) {
+    uint64_t fingerprint = 0;
+    if (command != "HELLO" || !(fields >> fingerprint) ||
+        fingerprint != fingerprint_) {
+      SendLine(worker->fd, "REJECT different configuration");
+      return false;
+    }
+    worker->welcomed = true;
+    return SendLine(worker->fd, "WELCOME " + shm_name_ + " " + HostId());
+  }
+  if (command == "RETURN") {
+    int64_t begin, end;
+    if (!(fields >> begin >> end)) {
+      return false;
+    }
+    // Only the part of the worker's range it did not finish comes back.
+    if (worker->has_lease && worker->lease.begin <= begin && begin < end &&
+        end <= worker->lease.end) {
+      returned_.push_back(Lease{worker->lease.seed, begin, end});
+    }
+    worker->has_lease = false;
+    return true;
+  }
+
+  SharedRun::Counters progress;
+  if (!ParseProgress(fields, &progress)) {
+    return false;
+  }
+  run_->AddCounters(progress);
+  if (command == "SOLVED") {
+    std::vector<uint32_t> solution;
+    uint32_t word;
+    while (fields >> word) {
+      solution.push_back(word);
+    }
+    worker->has_lease = false;
+    run_->PublishSolution(solution);
+    return true;
+  }
+  if (command == "DONE") {
+    worker->has_lease = false;
+    return true;
+  }
+  if (command != "LEASE") {
+    return false;
+  }
+
+  worker->has_lease = false;
+  if (run_->solved() || done()) {
+    return SendLine(worker->fd, "STOP");
+  }
+  if (!returned_.empty()) {
+    worker->lease = returned_.back();
+    returned_.pop_back();
+  } else if (next_attempt_ < num_attempts_) {
+    int64_t end = std::min(next_attempt_ + lease_size_, num_attempts_);
+    worker->lease = Lease{seed_, next_attempt_, end};
+    next_attempt_ = end;
+  } else {
+    return SendLine(worker->fd, "STOP");
+  }
+  worker->has_lease = true;
+  std::ostringstream reply;
+  reply << "RANGE " << worker->lease.seed << " " << worker->lease.begin << " "
+        << worker->lease.end;
+  return SendLine(worker->fd, reply.str());
+}
+
+void Coordinator::Serve(const volatile bool *interrupted) {
+  while (!*interrupted && !run_->solved() && !done()) {
+    Poll();
+  }
+
+  // Tell everyone to stop, then give them a moment to report their final
+  // progress.
+  for (const auto &worker : workers_) {
+    SendLine(worker.fd, "STOP");
+  }
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::milliseconds(kDrainMilliseconds);
+  while (!workers_.empty() && std::chrono::steady_clock::now() < deadline) {
+    Poll();
+  }
+}
+
+void Coordinator::Poll() {
+  std::vector<struct pollfd> fds(1 + workers_.size());
+  fds[0] = {listen_fd_, POLLIN, 0};
+  for (size_t i = 0; i < workers_.size(); i++) {
+    fds[1 + i] = {workers_[i].fd, POLLIN, 0};
+  }
+  if (poll(fds.data(), fds.size(), kPollMilliseconds) <= 0) {
+    return;
+  }
+
+  // Workers are served in reverse so that dropping one does not shift
+  // the ones still to be served.
+  for (size_t i = workers_.size(); i > 0; i--) {
+    if (fds[i].revents == 0) {
+      continue;
+    }
+    Worker &worker = workers_[i - 1];
+    bool alive = Receive(worker.fd, &worker.buffer);
+    std::string line;
+    while (alive && TakeLine(&worker.buffer, &line)) {
+      alive = Handle(&worker, line);
+    }
+    if (!alive) {
+      Drop(i - 1);
+    }
+  }
+  if (fds[0].revents & POLLIN) {
+    int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd >= 0) {
+      int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      workers_.push_back(Worker{fd, "", false, false, Lease{0, 0, 0}});
+    }
+  }
+}
+
+/* static */
+std::unique_ptr<CoordinatorClient> CoordinatorClient::Connect(
+    const std::string &address, uint64_t fingerprint) {
+  int fd = OpenSocket(address, false);
+  if (fd < 0) {
+    std::cerr << "Could not connect to " << address << ": " << strerror(errno)
+              << std::endl;
+    return nullptr;
+  }
+
+  std::unique_ptr<CoordinatorClient> client(new CoordinatorClient(fd));
+  std::string line;
+  if (!client->WriteLine("HELLO " + std::to_string(fingerprint)) ||
+      !client->ReadLine(&line, -1)) {
+    // A coordinator that is done closes connections without a reply.
+    std::cerr << "Coordinator at " << address
+              << " has exited; the run is already over." << std::endl;
+    return nullptr;
+  }
+  if (line.compare(0, 7, "REJECT ") == 0) {
+    std::cerr << "Coordinator at " << address
+              << " runs a different configuration." << std::endl;
+    return nullptr;
+  }
+  if (line.compare(0, 8, "WELCOME ") != 0) {
+    std::cerr << "Unexpected reply from coordinator at " << address << ": "
+              << line << std::endl;
+    return nullptr;
+  }
+  std::istringstream fields(line.substr(8));
+  std::string host_id;
+  fields >> client->shm_name_ >> host_id;
+  client->same_host_ = host_id == HostId();
+  return client;
+}
+
+CoordinatorClient::CoordinatorClient(int fd)
+    : fd_(fd), same_host_(false), stopped_(false) {}
+
+CoordinatorClient::~CoordinatorClient() { close(fd_); }
+
+bool CoordinatorClient::ReadLine(std::string *line, int timeout_ms) {
+  while (!TakeLine(&buffer_, line)) {
+    struct pollfd fd = {fd_, POLLIN, 0};
+    if (poll(&fd, 1, timeout_ms) <= 0) {
+      return false;
+    }
+    if (!Receive(fd_, &buffer_)) {
+      // The coordinator only goes away once the run is over.
+      stopped_ = true;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CoordinatorClient::WriteLine(const std::string &line) {
+  return SendLine(fd_, line);
+}
+
+bool CoordinatorClient::NextLease(const SharedRun::Counters &progress,
+                                  Lease *lease) {
+  if (stopped_ || !WriteLine("LEASE " + FormatProgress(progress))) {
+    return false;
+  }
+  std::string line;
+  while (ReadLine(&line, -1)) {
+    std::istringstream fields(line);
+    std::string command;
+    fields >> command;
+    // A STOP pushed earlier may still be queued ahead of the reply.
+    if (command == "STOP") {
+      stopped_ = true;
+      return false;
+    }
+    if (command == "RANGE" &&
+        fields >> lease->seed >> lease->begin >> lease->end) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void CoordinatorClient::Return(const Lease &unfinished) {
+  std::ostringstream line;
+  line << "RETURN " << unfinished.begin << " " << unfinished.end;
+  WriteLine(line.str());
+}
+
+void CoordinatorClient::Finish(const SharedRun::Counters &progress) {
+  WriteLine("DONE " + FormatProgress(progress));
+}
+
+void CoordinatorClient::ReportSolution(const SharedRun::Counters &progress,
+                                       const std::vector<uint32_t> &solution) {
+  std::ostringstream line;
+  line << "SOLVED " << FormatProgress(progress);
+  for (uint32_t word : solution) {
+    line << " " << word;
+  }
+  WriteLine(line.str());
+}
+
+bool CoordinatorClient::StopReceived(int timeout_ms) {
+  std::string line;
+  if (!stopped_ && ReadLine(&line, timeout_ms)) {
+    stopped_ = line == "STOP";
+  }
+  return stopped_;
+}
+
+}  // namespace anneal
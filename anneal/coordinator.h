@@ -0,0 +1,146 @@
+#ifndef ANNEAL_COORDINATOR_H_
+#define ANNEAL_COORDINATOR_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "shared_run.h"
+
+namespace anneal {
+
+// Attempts [begin, end) of the random streams of `seed`.
+struct Lease {
+  uint64_t seed;
+  int64_t begin;
+  int64_t end;
+};
+
+// Hands out ranges of attempts to worker processes over a Unix domain or
+// TCP socket, so that a run can be spread over many processes and hosts
+// without two of them repeating an attempt.
+//
+// The protocol is line based text. A worker starts with
+//   HELLO <fingerprint>
+// which is answered with WELCOME <shared memory name> <host id>, or with
+// REJECT if the worker runs a different configuration. Only workers on the
+// coordinator's host, as told by the host id, attach to the shared memory. It then repeatedly sends
+//   LEASE <attempts> <accepted> <rejected>
+// with its progress since its previous message, and is answered with
+//   RANGE <seed> <begin> <end>
+// or STOP once the run is over. A worker that solves the board sends
+//   SOLVED <attempts> <accepted> <rejected> <word>...
+// A worker that stops before the end of its range, e.g. when interrupted,
+// gives the attempts it did not finish back with
+//   RETURN <begin> <end>
+// so that they are handed out again, and reports its final progress with
+//   DONE <attempts> <accepted> <rejected>
+// which is not answered. When the run is over the coordinator pushes STOP to
+// every worker without waiting to be asked, so that workers which do not
+// attach to the shared memory, e.g. those on other hosts, stop within their
+// next poll too. It then waits briefly for their final
+// DONE, so that their progress is counted.
+class Coordinator {
+ public:
+  Coordinator(SharedRun *run, const std::string &shm_name,
+              uint64_t fingerprint, uint64_t seed, int64_t num_attempts,
+              int64_t lease_size);
+  Coordinator(const Coordinator &) = delete;
+  Coordinator &operator=(const Coordinator &) = delete;
+  ~Coordinator();
+
+  // Listens on `address`: host:port for TCP, where an empty host means every
+  // interface, or else the path of a Unix domain socket.
+  bool Listen(const std::string &address);
+  // The address listened on, with the port picked by the kernel if port 0
+  // was asked for.
+  const std::string &address() const { return address_; }
+
+  // Serves workers until the run is solved, every attempt has been run, or
+  // *interrupted is set. Ranges held by workers that disconnect are handed
+  // out again.
+  void Serve(const volatile bool *interrupted);
+
+ private:
+  struct Worker {
+    int fd;
+    std::string buffer;
+    bool welcomed;
+    bool has_lease;
+    Lease lease;
+  };
+
+  // Serves whatever the workers have sent within one poll interval.
+  void Poll();
+  // Returns false if the worker should be dropped.
+  bool Handle(Worker *worker, const std::string &line);
+  void Drop(size_t index);
+  bool done() const;
+
+  SharedRun *const run_;
+  const std::string shm_name_;
+  const uint64_t fingerprint_;
+  const uint64_t seed_;
+  const int64_t num_attempts_;
+  const int64_t lease_size_;
+
+  std::string address_;
+  int listen_fd_;
+  int64_t next_attempt_;
+  std::vector<Lease> returned_;
+  std::vector<Worker> workers_;
+};
+
+// The worker side of the Coordinator protocol.
+class CoordinatorClient {
+ public:
+  // Connects to a coordinator listening on `address`, as given to
+  // Coordinator::Listen. Returns nullptr (and reports why on stderr) if the
+  // coordinator cannot be reached or rejects the configuration.
+  static std::unique_ptr<CoordinatorClient> Connect(const std::string &address,
+                                                    uint64_t fingerprint);
+  CoordinatorClient(const CoordinatorClient &) = delete;
+  CoordinatorClient &operator=(const CoordinatorClient &) = delete;
+  ~CoordinatorClient();
+
+  const std::string &shm_name() const { return shm_name_; }
+  // Whether the coordinator runs on this host, so that its shared memory
+  // can be attached.
+  bool same_host() const { return same_host_; }
+
+  // Reports the progress since the previous call and asks for the next
+  // range. Returns false once the run is over.
+  bool NextLease(const SharedRun::Counters &progress, Lease *lease);
+  void ReportSolution(const SharedRun::Counters &progress,
+                      const std::vector<uint32_t> &solution);
+  // Gives attempts [unfinished.begin, unfinished.end) of the current range
+  // back to be run by another worker.
+  void Return(const Lease &unfinished);
+  // Reports the final progress of a worker that did not solve the board.
+  void Finish(const SharedRun::Counters &progress);
+
+  // Returns true if the coordinator has pushed STOP, waiting up to
+  // timeout_ms for it.
+  bool StopReceived(int timeout_ms);
+
+ private:
+  explicit CoordinatorClient(int fd);
+
+  // Reads a line, waiting up to timeout_ms or forever if negative. Returns
+  // false on timeout or if the coordinator went away, which counts as STOP.
+  bool ReadLine(std::string *line, int timeout_ms);
+  bool WriteLine(const std::string &line);
+
+  int fd_;
+  std::string buffer_;
+  std::string shm_name_;
+  bool same_host_;
+  bool stopped_;
+};
+
+}  // namespace anneal
+
+#endif  // ANNEAL_COORDINATOR_H_
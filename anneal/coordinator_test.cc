@@ -0,0 +1,191 @@
+#include "coordinator.h"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <set>
+#include <thread>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+using anneal::Coordinator;
+using anneal::CoordinatorClient;
+using anneal::Lease;
+using anneal::SharedRun;
+
+static const uint64_t kFingerprint = 42;
+
+static std::string SocketPath() {
+  const char *dir = getenv("TEST_TMPDIR");
+  return std::string(dir != nullptr ? dir : "/tmp") + "/coordinator_test." +
+         std::to_string(getpid()) + ".sock";
+}
+
+static std::string SegmentName() {
+  return "/anneal_coordinator_test_" + std::to_string(getpid());
+}
+
+// A coordinator serving on a background thread.
+class CoordinatorTest : public ::testing::Test {
+ protected:
+  void Start(int64_t num_attempts, int64_t lease_size,
+             const std::string &address = SocketPath()) {
+    run_ = SharedRun::Create(SegmentName(), kFingerprint, 4);
+    ASSERT_TRUE(run_ != nullptr);
+    coordinator_.reset(new Coordinator(run_.get(), SegmentName(),
+                                       kFingerprint, 7, num_attempts,
+                                       lease_size));
+    ASSERT_TRUE(coordinator_->Listen(address));
+    server_ = std::thread([this]() { coordinator_->Serve(&interrupted_); });
+  }
+
+  void TearDown() override {
+    interrupted_ = true;
+    if (server_.joinable()) {
+      server_.join();
+    }
+  }
+
+  std::unique_ptr<SharedRun> run_;
+  std::unique_ptr<Coordinator> coordinator_;
+  std::thread server_;
+  volatile bool interrupted_ = false;
+};
+
+TEST_F(CoordinatorTest, LeasesCoverAttemptsOnce) {
+  Start(10, 4);
+  auto first = CoordinatorClient::Connect(SocketPath(), kFingerprint);
+  auto second = CoordinatorClient::Connect(SocketPath(), kFingerprint);
+  ASSERT_TRUE(first != nullptr);
+  ASSERT_TRUE(second != nullptr);
+  EXPECT_EQ(SegmentName(), first->shm_name());
+
+  // Each worker reports the attempts of its previous lease as done.
+  std::multiset<int64_t> attempts;
+  auto next = [&attempts](CoordinatorClient *client, int64_t *done) {
+    Lease lease;
+    if (!client->NextLease(SharedRun::Counters{(uint64_t)*done, 1, 2},
+                           &lease)) {
+      return false;
+    }
+    EXPECT_EQ(7U, lease.seed);
+    for (int64_t attempt = lease.begin; attempt < lease.end; attempt++) {
+      attempts.insert(attempt);
+    }
+    *done = lease.end - lease.begin;
+    return true;
+  };
+  int64_t first_done = 0, second_done = 0;
+  bool first_running = true, second_running = true;
+  while (first_running || second_running) {
+    first_running = first_running && next(first.get(), &first_done);
+    second_running = second_running && next(second.get(), &second_done);
+  }
+  EXPECT_EQ(10U, attempts.size());
+  for (int64_t attempt = 0; attempt < 10; attempt++) {
+    EXPECT_EQ(1U, attempts.count(attempt));
+  }
+  server_.join();
+  EXPECT_EQ(10U, run_->counters().attempts);
+}
+
+TEST_F(CoordinatorTest, LeaseOfDisconnectedWorkerIsHandedOutAgain) {
+  Start(4, 4);
+  Lease lease;
+  {
+    auto quitter = CoordinatorClient::Connect(SocketPath(), kFingerprint);
+    ASSERT_TRUE(quitter != nullptr);
+    ASSERT_TRUE(quitter->NextLease(SharedRun::Counters{0, 0, 0}, &lease));
+  }
+  auto worker = CoordinatorClient::Connect(SocketPath(), kFingerprint);
+  ASSERT_TRUE(worker != nullptr);
+  ASSERT_TRUE(worker->NextLease(SharedRun::Counters{0, 0, 0}, &lease));
+  EXPECT_EQ(0, lease.begin);
+  EXPECT_EQ(4, lease.end);
+  EXPECT_FALSE(worker->NextLease(SharedRun::Counters{4, 0, 0}, &lease));
+}
+
+TEST_F(CoordinatorTest, ReturnedAttemptsAreHandedOutAgain) {
+  Start(8, 4);
+  Lease lease;
+  auto quitter = CoordinatorClient::Connect(SocketPath(), kFingerprint);
+  ASSERT_TRUE(quitter != nullptr);
+  ASSERT_TRUE(quitter->NextLease(SharedRun::Counters{0, 0, 0}, &lease));
+  // Interrupted after finishing attempts 0 and 1.
+  quitter->Return(Lease{lease.seed, 2, 4});
+  quitter->Finish(SharedRun::Counters{2, 0, 0});
+
+  auto worker = CoordinatorClient::Connect(SocketPath(), kFingerprint);
+  ASSERT_TRUE(worker != nullptr);
+  ASSERT_TRUE(worker->NextLease(SharedRun::Counters{0, 0, 0}, &lease));
+  EXPECT_EQ(2, lease.begin);
+  EXPECT_EQ(4, lease.end);
+  ASSERT_TRUE(worker->NextLease(SharedRun::Counters{2, 0, 0}, &lease));
+  EXPECT_EQ(4, lease.begin);
+  EXPECT_EQ(8, lease.end);
+  EXPECT_FALSE(worker->NextLease(SharedRun::Counters{4, 0, 0}, &lease));
+  server_.join();
+  EXPECT_EQ(8U, run_->counters().attempts);
+}
+
+TEST_F(CoordinatorTest, SolutionStopsOtherWorkers) {
+  Start(1000, 1);
+  auto solver = CoordinatorClient::Connect(SocketPath(), kFingerprint);
+  auto other = CoordinatorClient::Connect(SocketPath(), kFingerprint);
+  ASSERT_TRUE(solver != nullptr);
+  ASSERT_TRUE(other != nullptr);
+  Lease lease;
+  ASSERT_TRUE(solver->NextLease(SharedRun::Counters{0, 0, 0}, &lease));
+  ASSERT_TRUE(other->NextLease(SharedRun::Counters{0, 0, 0}, &lease));
+  EXPECT_FALSE(other->StopReceived(0));
+
+  solver->ReportSolution(SharedRun::Counters{1, 5, 6}, {1, 3, 0, 2});
+  EXPECT_TRUE(other->StopReceived(1000));
+  server_.join();
+  std::vector<uint32_t> solution;
+  ASSERT_TRUE(run_->ReadSolution(&solution));
+  EXPECT_EQ((std::vector<uint32_t>{1, 3, 0, 2}), solution);
+}
+
+TEST_F(CoordinatorTest, ServesOverTcp) {
+  Start(4, 4, "127.0.0.1:0");
+  EXPECT_NE("127.0.0.1:0", coordinator_->address());
+  auto worker =
+      CoordinatorClient::Connect(coordinator_->address(), kFingerprint);
+  ASSERT_TRUE(worker != nullptr);
+  EXPECT_EQ(SegmentName(), worker->shm_name());
+  EXPECT_TRUE(worker->same_host());
+  Lease lease;
+  ASSERT_TRUE(worker->NextLease(SharedRun::Counters{0, 0, 0}, &lease));
+  EXPECT_EQ(0, lease.begin);
+  EXPECT_EQ(4, lease.end);
+  EXPECT_FALSE(worker->NextLease(SharedRun::Counters{4, 0, 0}, &lease));
+  server_.join();
+  EXPECT_EQ(4U, run_->counters().attempts);
+}
+
+TEST_F(CoordinatorTest, RejectsOtherConfigurations) {
+  Start(10, 4);
+  testing::internal::CaptureStderr();
+  EXPECT_TRUE(CoordinatorClient::Connect(SocketPath(), kFingerprint + 1) ==
+              nullptr);
+  EXPECT_NE(std::string::npos, testing::internal::GetCapturedStderr().find(
+                                   "runs a different configuration"));
+}
+
+TEST_F(CoordinatorTest, ReportsCoordinatorThatHasExited) {
+  Start(10, 4);
+  interrupted_ = true;
+  server_.join();
+  // The connection waits in the backlog until the coordinator goes away.
+  std::thread closer([this]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    coordinator_.reset();
+  });
+  testing::internal::CaptureStderr();
+  EXPECT_TRUE(CoordinatorClient::Connect(SocketPath(), kFingerprint) ==
+              nullptr);
+  closer.join();
+  EXPECT_NE(std::string::npos,
+            testing::internal::GetCapturedStderr().find("has exited"));
+}
@@ -0,0 +1,509 @@
+#include "driver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <signal.h>
+
+#include "checkpoint.h"
+#include "coordinator.h"
+#include "shared_run.h"
+#include "stats.h"
+#include "topology.h"
+#include "trace.h"
+
+namespace anneal {
+
+static volatile bool solved = false;
+static volatile bool interrupted = false;
+
+static void handle_signal(int signum) { solved = interrupted = true; }
+
+// Stats of the workers of each socket, so that with --pin_threads workers
+// only write to counters in their own socket's cache. A single one otherwise.
+typedef std::vector<std::unique_ptr<Stats>> SocketStats;
+
+// With --pin_threads, the stats of each socket are allocated, and thereby
+// first touched, by a thread pinned to one of its CPUs, so that they live
+// in the socket's own memory.
+static SocketStats NewSocketStats(const CpuTopology &topology,
+                                  const RunOptions &options) {
+  SocketStats stats(options.pin_threads ? topology.num_sockets() : 1);
+  if (!options.pin_threads) {
+    stats[0].reset(new Stats());
+    return stats;
+  }
+  for (size_t worker = 0; worker < topology.num_cpus(); worker++) {
+    const CpuTopology::Cpu &cpu = topology.ForWorker(worker);
+    if (stats[cpu.socket] == nullptr) {
+      // PlaceWorker reports threads that cannot be pinned.
+      std::thread([&stats, &cpu]() {
+        CpuTopology::Pin(cpu);
+        stats[cpu.socket].reset(new Stats());
+      }).join();
+    }
+  }
+  return stats;
+}
+
+static void MergeStats(const SocketStats &stats, Stats *total) {
+  for (const auto &socket : stats) {
+    total->Add(*socket);
+  }
+}
+
+static std::ostream &DumpStats(const SocketStats &stats, std::ostream &os) {
+  if (stats.size() > 1) {
+    for (size_t socket = 0; socket < stats.size(); socket++) {
+      os << "Socket " << socket << ":         " << stats[socket]->GetAccepted()
+         << " accepted, " << stats[socket]->GetRejected() << " rejected"
+         << std::endl;
+    }
+  }
+  Stats total;
+  MergeStats(stats, &total);
+  return total.Dump(os);
+}
+
+// With --pin_threads, pins the calling thread, the `worker`th of its wave,
+// to its core. Returns the stats the worker reports to. Called before the
+// worker sets up its attempt, so that its state and generator are first
+// touched, and thereby allocated, on the worker's NUMA node.
+static Stats *PlaceWorker(const CpuTopology &topology,
+                          const SocketStats &stats, const RunOptions &options,
+                          size_t worker) {
+  if (!options.pin_threads) {
+    return stats[0].get();
+  }
+  const CpuTopology::Cpu &cpu = topology.ForWorker(worker);
+  static std::atomic<bool> warned(false);
+  if (!CpuTopology::Pin(cpu) && !warned.exchange(true)) {
+    std::cerr << "Could not pin threads; running unpinned." << std::endl;
+  }
+  return stats[cpu.socket].get();
+}
+
+// Opens --trace_file with a ring per solver thread, if tracing. Returns false
+// on error.
+static bool OpenTrace(const RunOptions &options,
+                      std::unique_ptr<TraceWriter> *tracer) {
+  if (!options.trace_file.empty()) {
+    *tracer = TraceWriter::Open(options.trace_file, options.num_threads);
+    return *tracer != nullptr;
+  }
+  return true;
+}
+
+// Finalizes the trace, if tracing, and reports where it was written.
+static void CloseTrace(const RunOptions &options,
+                       std::unique_ptr<TraceWriter> *tracer) {
+  if (*tracer != nullptr && (*tracer)->Close()) {
+    std::cout << "Trace of " << (*tracer)->num_records()
+              << " records written to " << options.trace_file << std::endl;
+  }
+}
+
+// Races configurations against each other and writes the fastest to
+// --autotune_output.
+static int RunAutotune(const DriverProblem &problem,
+                       const SolverConfig &config, const RunOptions &options,
+                       uint64_t seed) {
+  TuneOptions tune;
+  tune.budget_seconds = options.autotune_budget_seconds;
+  tune.num_candidates = options.autotune_candidates;
+  tune.max_threads = std::max(1u, std::thread::hardware_concurrency());
+  tune.seed = seed;
+  tune.log = &std::cout;
+  TuneResult result = Autotune(problem.run_to_solution, config, tune);
+  std::ostringstream comment;
+  comment << "Written by --autotune for " << problem.description << ".";
+  if (!WriteFlagFile(options.autotune_output, result, comment.str())) {
+    return 1;
+  }
+  std::cout << "Best: " << result.config.ToString()
+            << ", num_threads=" << result.num_threads << ". Written to "
+            << options.autotune_output << std::endl;
+  return 0;
+}
+
+// Hands out the attempts of the run to the workers connecting to --serve,
+// and reports the solution one of them finds.
+static int Serve(const DriverProblem &problem, const RunOptions &options,
+                 uint64_t fingerprint, uint64_t seed) {
+  std::unique_ptr<SharedRun> run =
+      SharedRun::Create(options.shm_name, fingerprint, problem.num_words);
+  if (run == nullptr) {
+    return 1;
+  }
+  Coordinator coordinator(run.get(), options.shm_name, fingerprint, seed,
+                          options.num_attempts, options.lease_size);
+  if (!coordinator.Listen(options.serve)) {
+    return 1;
+  }
+  std::cout << "Serving " << options.num_attempts << " attempts on "
+            << coordinator.address() << "." << std::endl;
+
+  auto print_counters = [&run]() {
+    SharedRun::Counters counters = run->counters();
+    std::cout << "Attempts:         " << counters.attempts << std::endl
+              << "Rejected configs: " << counters.rejected << std::endl
+              << "Accepted configs: " << counters.accepted << std::endl;
+  };
+  if (options.stats_interval_seconds > 0) {
+    int32_t interval = options.stats_interval_seconds;
+    std::thread([&print_counters, interval]() {
+      while (true) {
+        std::this_thread::sleep_for(std::chrono::seconds(interval));
+        if (solved) {
+          break;
+        }
+        print_counters();
+      }
+    }).detach();
+  }
+
+  coordinator.Serve(&interrupted);
+  std::vector<uint32_t> solution;
+  // The solving process may still be writing out its solution.
+  for (int i = 0; i < 1000 && run->solved() && !run->ReadSolution(&solution);
+       i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  solved = true;
+  if (!solution.empty()) {
+    problem.print(solution.data(), std::cout);
+  }
+  print_counters();
+  return solution.empty() ? 1 : 0;
+}
+
+// Runs the attempts handed out by the coordinator at --coordinator until the
+// run is over.
+static int RunWorker(const DriverProblem &problem, const RunOptions &options,
+                     uint64_t fingerprint) {
+  std::unique_ptr<CoordinatorClient> client =
+      CoordinatorClient::Connect(options.coordinator, fingerprint);
+  if (client == nullptr) {
+    return 1;
+  }
+  // Workers on other hosts, and those that cannot attach, only hear of a
+  // solution through the socket.
+  std::unique_ptr<SharedRun> run;
+  if (client->same_host()) {
+    run = SharedRun::Attach(client->shm_name(), fingerprint, problem.num_words);
+  }
+
+  CpuTopology cpus = CpuTopology::Read();
+  SocketStats stats = NewSocketStats(cpus, options);
+  std::unique_ptr<TraceWriter> tracer;
+  if (!OpenTrace(options, &tracer)) {
+    return 1;
+  }
+  // Islands migrate between the threads of this worker only.
+  std::unique_ptr<ElitePool> elites;
+  if (options.migration_interval > 0) {
+    elites.reset(new ElitePool(options.num_threads, problem.num_words,
+                               options.topology));
+  }
+  uint64_t num_attempts = 0;
+  SharedRun::Counters reported = {0, 0, 0};
+  auto progress = [&]() {
+    Stats total;
+    MergeStats(stats, &total);
+    SharedRun::Counters now = {num_attempts, total.GetAccepted(),
+                               total.GetRejected()};
+    SharedRun::Counters delta = {now.attempts - reported.attempts,
+                                 now.accepted - reported.accepted,
+                                 now.rejected - reported.rejected};
+    reported = now;
+    return delta;
+  };
+
+  std::mutex solution_mutex;
+  std::vector<uint32_t> solution;
+  Lease lease = {0, 0, 0};
+  // The first attempt of the current range that has not run to its end.
+  int64_t unfinished = 0;
+  while (!solved && client->NextLease(progress(), &lease)) {
+    std::atomic<bool> lease_done(false);
+    std::thread watcher([&]() {
+      while (!lease_done && !solved) {
+        if ((run != nullptr && run->solved()) || client->StopReceived(1)) {
+          solved = true;
+        }
+      }
+    });
+
+    unfinished = lease.begin;
+    while (unfinished < lease.end && !solved) {
+      int64_t begin = unfinished;
+      int64_t end = std::min<int64_t>(begin + options.num_threads, lease.end);
+      // Whether each attempt of the wave ran to its end, rather than being
+      // stopped by a solution or an interrupt.
+      std::unique_ptr<bool[]> finished(new bool[end - begin]());
+      std::vector<std::thread> threads;
+      for (int64_t attempt = begin; attempt < end; attempt++) {
+        threads.emplace_back([&, begin, attempt]() {
+          SolverContext context;
+          context.stats = PlaceWorker(cpus, stats, options, attempt - begin);
+          context.trace =
+              tracer != nullptr ? tracer->ring(attempt - begin) : nullptr;
+          std::vector<uint32_t> words;
+          context.found = &solved;
+          context.perf_counters = options.perf_counters;
+          context.elites = elites.get();
+          context.island = attempt - begin;
+          context.migration_interval = options.migration_interval;
+          context.log = &std::cout;
+          context.solution = &words;
+          if (!problem.solve(context, lease.seed, attempt, nullptr).solved) {
+            finished[attempt - begin] = !solved;
+            return;
+          }
+          finished[attempt - begin] = true;
+          if (run != nullptr) {
+            run->PublishSolution(words);
+          }
+          std::lock_guard<std::mutex> lock(solution_mutex);
+          solution = words;
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      // Attempts after the first unfinished one run again with the rest of
+      // the range, so only those before it count.
+      while (unfinished < end && finished[unfinished - begin]) {
+        unfinished++;
+      }
+      num_attempts += unfinished - begin;
+      if (unfinished < end) {
+        break;
+      }
+    }
+
+    lease_done = true;
+    watcher.join();
+  }
+
+  if (!solution.empty()) {
+    client->ReportSolution(progress(), solution);
+  } else {
+    if (unfinished < lease.end) {
+      client->Return(Lease{lease.seed, unfinished, lease.end});
+    }
+    client->Finish(progress());
+  }
+  CloseTrace(options, &tracer);
+  DumpStats(stats, std::cout);
+  return solution.empty() ? 1 : 0;
+}
+
+// Runs the attempts in waves of --num_threads threads, resuming those of
+// --checkpoint_file first with --resume.
+static int RunThreads(const DriverProblem &problem, const RunOptions &options,
+                      uint64_t fingerprint, uint64_t seed) {
+  CpuTopology cpus = CpuTopology::Read();
+  SocketStats stats = NewSocketStats(cpus, options);
+  int64_t num_attempts = options.num_attempts;
+  int64_t remaining_tries = num_attempts;
+
+  // Attempts of the checkpoint that had started; resume is null for those
+  // that start over.
+  struct Pending {
+    int64_t attempt;
+    const char *resume;
+  };
+  std::unique_ptr<Checkpointer> checkpointer;
+  std::unique_ptr<CheckpointReader> resumed;
+  std::vector<Pending> pending;
+  if (!options.checkpoint_file.empty() && options.resume) {
+    resumed = CheckpointReader::Open(options.checkpoint_file, fingerprint,
+                                     CheckpointPayloadSize(problem.num_words));
+    if (resumed == nullptr) {
+      return 1;
+    }
+    // Attempts are numbered within the run as it was started, so that each
+    // still draws from its own random stream.
+    if (resumed->num_attempts() != num_attempts) {
+      std::cout << "Resuming a run of " << resumed->num_attempts()
+                << " attempts; --num_attempts=" << num_attempts
+                << " is ignored." << std::endl;
+      num_attempts = resumed->num_attempts();
+    }
+    remaining_tries = resumed->remaining_attempts();
+    for (size_t slot = 0; slot < resumed->num_slots(); slot++) {
+      if (resumed->has_attempt(slot)) {
+        pending.push_back(
+            Pending{resumed->attempt(slot),
+                    static_cast<const char *>(resumed->payload(slot))});
+      }
+    }
+    std::cout << "Resuming " << pending.size() << " attempts, "
+              << remaining_tries << " not yet started." << std::endl;
+  }
+
+  // Pending attempt k keeps slot k until it runs, whatever the number of
+  // threads, so that checkpoints taken in the meantime still hold it. New
+  // attempts take whichever slots are free.
+  size_t num_slots = std::max<size_t>(options.num_threads, pending.size());
+  std::vector<size_t> free_slots;
+  for (size_t slot = pending.size(); slot < num_slots; slot++) {
+    free_slots.push_back(slot);
+  }
+  if (!options.checkpoint_file.empty()) {
+    checkpointer.reset(
+        new Checkpointer(options.checkpoint_file, fingerprint, num_slots,
+                         CheckpointPayloadSize(problem.num_words)));
+    for (size_t slot = 0; slot < pending.size(); slot++) {
+      checkpointer->Begin(slot, pending[slot].attempt);
+      if (pending[slot].resume != nullptr) {
+        checkpointer->Publish(slot, pending[slot].resume);
+      }
+    }
+    checkpointer->set_num_attempts(num_attempts);
+    checkpointer->set_remaining_attempts(remaining_tries);
+    checkpointer->Start(
+        std::chrono::seconds(options.checkpoint_interval_seconds));
+  }
+
+  std::unique_ptr<TraceWriter> tracer;
+  if (!OpenTrace(options, &tracer)) {
+    return 1;
+  }
+
+  std::unique_ptr<ElitePool> elites;
+  if (options.migration_interval > 0) {
+    elites.reset(new ElitePool(options.num_threads, problem.num_words,
+                               options.topology));
+  }
+
+  if (options.stats_interval_seconds > 0) {
+    int32_t interval = options.stats_interval_seconds;
+    std::thread([&stats, interval]() {
+      while (true) {
+        std::this_thread::sleep_for(std::chrono::seconds(interval));
+        if (solved) {
+          break;
+        }
+        DumpStats(stats, std::cout) << std::endl;
+      }
+    }).detach();
+  }
+
+  size_t next_pending = 0;
+  while ((remaining_tries > 0 || next_pending < pending.size()) && !solved) {
+    int32_t num_resumed =
+        std::min<size_t>(options.num_threads, pending.size() - next_pending);
+    int32_t num_threads =
+        std::min<int64_t>(options.num_threads - num_resumed, remaining_tries);
+    std::cout << "Remaining tries: " << remaining_tries << " ... Starting "
+              << num_threads << " attempts";
+    if (num_resumed > 0) {
+      std::cout << ", resuming " << num_resumed;
+    }
+    std::cout << "." << std::endl;
+    // New attempts hold their slots before they leave the remaining ones, so
+    // that a checkpoint in between counts them twice rather than not at all.
+    int64_t first_attempt = num_attempts - remaining_tries;
+    if (checkpointer != nullptr) {
+      for (int i = 0; i < num_threads; i++) {
+        checkpointer->Begin(free_slots[i], first_attempt + i);
+      }
+      checkpointer->set_remaining_attempts(remaining_tries - num_threads);
+    }
+    remaining_tries -= num_threads;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_resumed + num_threads; i++) {
+      SolverContext context;
+      context.found = &solved;
+      context.checkpointer = checkpointer.get();
+      context.trace = tracer != nullptr ? tracer->ring(i) : nullptr;
+      context.perf_counters = options.perf_counters;
+      context.elites = elites.get();
+      context.island = i;
+      context.migration_interval = options.migration_interval;
+      context.log = &std::cout;
+      const char *resume = nullptr;
+      int64_t attempt;
+      if (i < num_resumed) {
+        context.slot = next_pending + i;
+        attempt = pending[next_pending + i].attempt;
+        resume = pending[next_pending + i].resume;
+      } else {
+        context.slot = free_slots[i - num_resumed];
+        attempt = first_attempt + (i - num_resumed);
+      }
+      threads.emplace_back([=, &problem, &options, &cpus, &stats]() mutable {
+        context.stats = PlaceWorker(cpus, stats, options, i);
+        problem.solve(context, seed, attempt, resume);
+      });
+    }
+
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    for (int i = 0; i < num_resumed; i++) {
+      free_slots.push_back(next_pending + i);
+    }
+    next_pending += num_resumed;
+  }
+
+  if (checkpointer != nullptr) {
+    checkpointer->Stop();
+    if (interrupted) {
+      checkpointer->Write();
+      std::cout << "Checkpoint written to " << options.checkpoint_file
+                << std::endl;
+    } else {
+      checkpointer->Remove();
+    }
+  }
+
+  CloseTrace(options, &tracer);
+  DumpStats(stats, std::cout);
+
+  return solved ? 0 : 1;
+}
+
+int RunDriver(const DriverProblem &problem, const SolverConfig &config,
+              const RunOptions &options) {
+  uint64_t seed = options.seed;
+  if (seed == 0) {
+    seed = std::chrono::system_clock::now().time_since_epoch().count();
+  }
+  std::cout << "Seed: " << seed << std::endl;
+
+  if (options.autotune) {
+    return RunAutotune(problem, config, options, seed);
+  }
+
+  // Checkpoints and the processes of a run have to agree on this.
+  uint64_t fingerprint = Checkpointer::Fingerprint(problem.description + " " +
+                                                   config.ToString());
+
+  signal(SIGINT, &handle_signal);
+  signal(SIGTERM, &handle_signal);
+
+  if (!options.serve.empty() || !options.coordinator.empty()) {
+    if (!options.checkpoint_file.empty()) {
+      std::cerr << "--checkpoint_file cannot be combined with --serve or "
+                   "--coordinator."
+                << std::endl;
+      return 1;
+    }
+    return options.serve.empty()
+               ? RunWorker(problem, options, fingerprint)
+               : Serve(problem, options, fingerprint, seed);
+  }
+  return RunThreads(problem, options, fingerprint, seed);
+}
+
+}  // namespace anneal
@@ -0,0 +1,94 @@
+#ifndef ANNEAL_DRIVER_H_
+#define ANNEAL_DRIVER_H_
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "config.h"
+#include "elite_pool.h"
+#include "solver.h"
+#include "tune.h"
+
+namespace anneal {
+
+// How a process runs its attempts, as given by the flags of nq and atax.
+struct RunOptions {
+  int32_t num_threads = 32;
+  int64_t num_attempts = 1024;
+  // Interval between reporting stats. No reporting if <= 0.
+  int32_t stats_interval_seconds = 10;
+  bool perf_counters = false;
+  // Picked (and printed) if 0.
+  uint64_t seed = 0;
+  // No checkpointing if empty.
+  std::string checkpoint_file;
+  int32_t checkpoint_interval_seconds = 60;
+  bool resume = false;
+  // At most one of serve and coordinator is set, to run as the coordinator
+  // or as a worker of a run spread over processes.
+  std::string serve;
+  std::string coordinator;
+  std::string shm_name;
+  int64_t lease_size = 64;
+  // No tracing if empty.
+  std::string trace_file;
+  bool pin_threads = false;
+  // No migration if <= 0.
+  int32_t migration_interval = 0;
+  Topology topology = Topology::Ring;
+  // Instead of solving, writes the fastest configuration found to
+  // autotune_output.
+  bool autotune = false;
+  double autotune_budget_seconds = 60;
+  int32_t autotune_candidates = 32;
+  std::string autotune_output;
+};
+
+// What the driver needs of a problem, bound by Run so that the driver itself
+// does not depend on the problem type.
+struct DriverProblem {
+  std::string description;
+  size_t num_words;
+  std::function<AttemptResult(const SolverContext &context, uint64_t seed,
+                              int64_t attempt, const char *resume)>
+      solve;
+  // Runs attempts of a configuration until solved, for --autotune.
+  AttemptRunner run_to_solution;
+  std::function<void(const uint32_t *words, std::ostream &os)> print;
+};
+
+// Runs `problem` as a single process, as the coordinator of a run spread
+// over processes or as one of its workers, and returns the exit code of the
+// process: 0 if solved.
+int RunDriver(const DriverProblem &problem, const SolverConfig &config,
+              const RunOptions &options);
+
+template <typename Problem>
+int Run(const Problem &problem, const SolverConfig &config,
+        const RunOptions &options) {
+  DriverProblem driver;
+  driver.description = problem.Describe();
+  driver.num_words = problem.num_words();
+  driver.solve = [&problem, &config](const SolverContext &context,
+                                     uint64_t seed, int64_t attempt,
+                                     const char *resume) {
+    return Solve(problem, config, context, seed, attempt, resume);
+  };
+  driver.run_to_solution = [&problem](const SolverConfig &config,
+                                      uint64_t seed) {
+    return RunToSolution(problem, config, seed, 1);
+  };
+  driver.print = [&problem](const uint32_t *words, std::ostream &os) {
+    problem.Print(problem.Decode(words), os);
+  };
+  return RunDriver(driver, config, options);
+}
+
+}  // namespace anneal
+
+#endif  // ANNEAL_DRIVER_H_
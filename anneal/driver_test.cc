@@ -0,0 +1,124 @@
+#include "driver.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+
+using anneal::AttemptResult;
+using anneal::Checkpointer;
+using anneal::CheckpointPayloadSize;
+using anneal::DriverProblem;
+using anneal::RunOptions;
+using anneal::SolverConfig;
+using anneal::SolverContext;
+
+static std::string TempPath() {
+  const char *dir = getenv("TEST_TMPDIR");
+  return std::string(dir != nullptr ? dir : "/tmp") + "/driver_test.ckpt";
+}
+
+// An attempt as seen by the problem: its number and the first byte of the
+// payload it resumed from, or 0 if it started afresh.
+struct Attempt {
+  int64_t attempt;
+  char resumed_from;
+
+  bool operator<(const Attempt &other) const {
+    return attempt < other.attempt;
+  }
+  bool operator==(const Attempt &other) const {
+    return attempt == other.attempt && resumed_from == other.resumed_from;
+  }
+};
+
+// A problem whose attempts never solve it and only record that they ran.
+static DriverProblem RecordingProblem(std::mutex *mutex,
+                                      std::vector<Attempt> *attempts) {
+  DriverProblem problem;
+  problem.description = "recording";
+  problem.num_words = 1;
+  problem.solve = [mutex, attempts](const SolverContext &context, uint64_t seed,
+                                int64_t attempt, const char *resume) {
+    if (context.checkpointer != nullptr) {
+      context.checkpointer->Clear(context.slot);
+    }
+    std::lock_guard<std::mutex> lock(*mutex);
+    attempts->push_back(
+        Attempt{attempt, resume != nullptr ? resume[0] : '\0'});
+    return AttemptResult{false, 1};
+  };
+  return problem;
+}
+
+static RunOptions Options(int32_t num_threads, int64_t num_attempts) {
+  RunOptions options;
+  options.num_threads = num_threads;
+  options.num_attempts = num_attempts;
+  options.stats_interval_seconds = 0;
+  options.seed = 1;
+  options.checkpoint_file = TempPath();
+  options.resume = true;
+  return options;
+}
+
+// Writes the checkpoint of a run of 10 attempts interrupted by hand with
+// attempts 5 and 7 in progress, attempt 6 begun but not yet checkpointed,
+// and attempts 8 and 9 not begun.
+static void WriteCheckpoint(const DriverProblem &problem,
+                            const SolverConfig &config, size_t num_slots) {
+  size_t payload_size = CheckpointPayloadSize(problem.num_words);
+  Checkpointer checkpointer(
+      TempPath(),
+      Checkpointer::Fingerprint(problem.description + " " + config.ToString()),
+      num_slots, payload_size);
+  std::vector<char> payload(payload_size, 'a');
+  checkpointer.Begin(0, 5);
+  checkpointer.Publish(0, payload.data());
+  checkpointer.Begin(1, 6);
+  payload[0] = 'b';
+  checkpointer.Begin(num_slots - 1, 7);
+  checkpointer.Publish(num_slots - 1, payload.data());
+  checkpointer.set_num_attempts(10);
+  checkpointer.set_remaining_attempts(2);
+  ASSERT_TRUE(checkpointer.Write());
+}
+
+static std::vector<Attempt> Resume(size_t num_slots, int32_t num_threads,
+                                   int64_t num_attempts = 10) {
+  std::mutex mutex;
+  std::vector<Attempt> attempts;
+  DriverProblem problem = RecordingProblem(&mutex, &attempts);
+  SolverConfig config;
+  WriteCheckpoint(problem, config, num_slots);
+  EXPECT_EQ(1, anneal::RunDriver(problem, config,
+                                 Options(num_threads, num_attempts)));
+  // Finished runs leave no checkpoint behind.
+  EXPECT_NE(0, access(TempPath().c_str(), F_OK));
+  std::sort(attempts.begin(), attempts.end());
+  return attempts;
+}
+
+static const std::vector<Attempt> kExpected = {
+    {5, 'a'}, {6, '\0'}, {7, 'b'}, {8, '\0'}, {9, '\0'}};
+
+TEST(DriverTest, ResumesWithFewerThreads) {
+  EXPECT_EQ(kExpected, Resume(4, 2));
+}
+
+TEST(DriverTest, ResumesWithOneThread) { EXPECT_EQ(kExpected, Resume(4, 1)); }
+
+TEST(DriverTest, ResumesWithMoreThreads) {
+  EXPECT_EQ(kExpected, Resume(3, 8));
+}
+
+// The attempts left are those of the run as it was started.
+TEST(DriverTest, ResumesWithTheNumberOfAttemptsOfTheCheckpoint) {
+  EXPECT_EQ(kExpected, Resume(4, 2, 20));
+  EXPECT_EQ(kExpected, Resume(4, 2, 8));
+}
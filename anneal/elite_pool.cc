@@ -0,0 +1,84 @@
+#include "elite_pool.h"
+
+#include <iostream>
+
+namespace anneal {
+
+bool ParseTopology(const std::string &name, Topology *topology) {
+  if (name == "ring") {
+    *topology = Topology::Ring;
+  } else if (name == "all") {
+    *topology = Topology::All;
+  } else {
+    std::cerr << "Unknown topology '" << name << "'" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+ElitePool::ElitePool(size_t num_islands, size_t num_words, Topology topology)
+    : num_islands_(num_islands),
+      num_words_(num_words),
+      slot_words_((2 + num_words + kLineWords - 1) / kLineWords * kLineWords),
+      topology_(topology),
+      slots_(new std::atomic<uint32_t>[num_islands * slot_words_]) {
+  for (size_t island = 0; island < num_islands_; island++) {
+    slot(island)[0].store(0, std::memory_order_relaxed);
+    slot(island)[1].store(kEmpty, std::memory_order_relaxed);
+  }
+}
+
+void ElitePool::Publish(size_t island, const uint32_t *words, uint32_t cost) {
+  std::atomic<uint32_t> *slot = this->slot(island);
+  if (cost >= slot[1].load(std::memory_order_relaxed)) {
+    return;
+  }
+  uint32_t sequence = slot[0].load(std::memory_order_relaxed);
+  slot[0].store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot[1].store(cost, std::memory_order_relaxed);
+  for (size_t i = 0; i < num_words_; i++) {
+    slot[2 + i].store(words[i], std::memory_order_relaxed);
+  }
+  slot[0].store(sequence + 2, std::memory_order_release);
+}
+
+bool ElitePool::Read(size_t island, uint32_t *cost, uint32_t *words) const {
+  const std::atomic<uint32_t> *slot = this->slot(island);
+  uint32_t before = slot[0].load(std::memory_order_acquire);
+  if (before & 1) {
+    return false;
+  }
+  *cost = slot[1].load(std::memory_order_relaxed);
+  for (size_t i = 0; i < num_words_; i++) {
+    words[i] = slot[2 + i].load(std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  uint32_t after = slot[0].load(std::memory_order_relaxed);
+  return before == after && *cost != kEmpty;
+}
+
+bool ElitePool::Adopt(size_t island, uint32_t cost, uint32_t *words,
+                      uint32_t *adopted_cost) const {
+  // Picks the neighbor with the best published cost, then copies its state;
+  // states are too large to copy every neighbor's on the way.
+  size_t best = island;
+  uint32_t best_cost = cost;
+  size_t first = topology_ == Topology::Ring
+                     ? (island + num_islands_ - 1) % num_islands_
+                     : 0;
+  size_t count = topology_ == Topology::Ring ? 1 : num_islands_;
+  for (size_t i = 0; i < count; i++) {
+    size_t neighbor = (first + i) % num_islands_;
+    uint32_t neighbor_cost = slot(neighbor)[1].load(std::memory_order_relaxed);
+    if (neighbor == island || neighbor_cost >= best_cost) {
+      continue;
+    }
+    best = neighbor;
+    best_cost = neighbor_cost;
+  }
+  // Costs of a slot only go down, so a successful read is still better.
+  return best != island && Read(best, adopted_cost, words);
+}
+
+}  // namespace anneal
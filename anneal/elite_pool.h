@@ -0,0 +1,75 @@
+#ifndef ANNEAL_ELITE_POOL_H_
+#define ANNEAL_ELITE_POOL_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace anneal {
+
+// Which islands a worker looks at when it migrates.
+enum class Topology {
+  // Only the previous island, so good states spread one island per
+  // migration and the others keep exploring in the meantime.
+  Ring,
+  // Every island; the best state spreads to all workers at once.
+  All,
+};
+
+// Parses "ring" or "all".
+bool ParseTopology(const std::string &name, Topology *topology);
+
+// Best states of the islands of an island-model search, one slot per island,
+// each encoded as num_words words by the problem. Each slot has a single
+// writer, the worker of that island, and is guarded by a sequence lock:
+// publishing never waits, and a read that races with a publication is simply
+// skipped, so no worker ever blocks on another.
+class ElitePool {
+ public:
+  ElitePool(size_t num_islands, size_t num_words, Topology topology);
+  ElitePool(const ElitePool &) = delete;
+  ElitePool &operator=(const ElitePool &) = delete;
+
+  size_t num_islands() const { return num_islands_; }
+  size_t num_words() const { return num_words_; }
+
+  // Publishes a state of `island`, unless the island already has one of
+  // lower or equal cost. Must only be called by the worker of that island.
+  void Publish(size_t island, const uint32_t *words, uint32_t cost);
+
+  // Looks for a state of lower cost than `cost` on the neighbors of
+  // `island`. On success, stores the best one found in words and its cost in
+  // *adopted_cost and returns true. On failure `words` may have been
+  // overwritten.
+  bool Adopt(size_t island, uint32_t cost, uint32_t *words,
+             uint32_t *adopted_cost) const;
+
+ private:
+  static constexpr uint32_t kEmpty = ~0U;
+  // Words of a cache line. Slots are padded to whole lines, so that islands
+  // do not share lines.
+  static constexpr size_t kLineWords = 64 / sizeof(uint32_t);
+
+  // A slot is its sequence number, odd while a publication is in progress,
+  // its cost and the words of its state.
+  std::atomic<uint32_t> *slot(size_t island) const {
+    return &slots_[island * slot_words_];
+  }
+
+  // Reads slot `island` into cost/words. Returns false if it is empty or was
+  // being written.
+  bool Read(size_t island, uint32_t *cost, uint32_t *words) const;
+
+  const size_t num_islands_;
+  const size_t num_words_;
+  const size_t slot_words_;
+  const Topology topology_;
+  std::unique_ptr<std::atomic<uint32_t>[]> slots_;
+};
+
+}  // namespace anneal
+
+#endif  // ANNEAL_ELITE_POOL_H_
@@ -0,0 +1,95 @@
+#include "elite_pool.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using anneal::ElitePool;
+using anneal::Topology;
+
+// Long enough for a slot to span two cache lines.
+static const size_t kNumWords = 20;
+
+// A state with every word equal to index + offset.
+static std::vector<uint32_t> Shifted(uint32_t offset) {
+  std::vector<uint32_t> words(kNumWords);
+  for (size_t index = 0; index < kNumWords; index++) {
+    words[index] = index + offset;
+  }
+  return words;
+}
+
+TEST(ElitePoolTest, EmptyPoolHasNothingToAdopt) {
+  ElitePool pool(4, kNumWords, Topology::All);
+  std::vector<uint32_t> words(kNumWords);
+  uint32_t cost;
+  EXPECT_FALSE(pool.Adopt(0, 10, words.data(), &cost));
+}
+
+TEST(ElitePoolTest, RingAdoptsFromPreviousIslandOnly) {
+  ElitePool pool(4, kNumWords, Topology::Ring);
+  pool.Publish(1, Shifted(1).data(), 3);
+  pool.Publish(3, Shifted(3).data(), 1);
+
+  std::vector<uint32_t> words(kNumWords);
+  uint32_t cost;
+  ASSERT_TRUE(pool.Adopt(2, 5, words.data(), &cost));
+  EXPECT_EQ(3U, cost);
+  EXPECT_EQ(Shifted(1), words);
+  // Island 0 sees island 3, which wraps around.
+  ASSERT_TRUE(pool.Adopt(0, 5, words.data(), &cost));
+  EXPECT_EQ(1U, cost);
+  // Nothing better than what island 2 has.
+  EXPECT_FALSE(pool.Adopt(2, 3, words.data(), &cost));
+  EXPECT_FALSE(pool.Adopt(1, 5, words.data(), &cost));
+}
+
+TEST(ElitePoolTest, AllAdoptsBestOfOtherIslands) {
+  ElitePool pool(4, kNumWords, Topology::All);
+  pool.Publish(0, Shifted(0).data(), 1);
+  pool.Publish(1, Shifted(1).data(), 4);
+  pool.Publish(2, Shifted(2).data(), 2);
+
+  std::vector<uint32_t> words(kNumWords);
+  uint32_t cost;
+  ASSERT_TRUE(pool.Adopt(3, 5, words.data(), &cost));
+  EXPECT_EQ(1U, cost);
+  EXPECT_EQ(Shifted(0), words);
+  // An island does not adopt its own state.
+  ASSERT_TRUE(pool.Adopt(0, 5, words.data(), &cost));
+  EXPECT_EQ(2U, cost);
+  EXPECT_EQ(Shifted(2), words);
+}
+
+TEST(ElitePoolTest, KeepsBestStateOfIsland) {
+  ElitePool pool(2, kNumWords, Topology::Ring);
+  pool.Publish(0, Shifted(0).data(), 2);
+  pool.Publish(0, Shifted(5).data(), 3);
+
+  std::vector<uint32_t> words(kNumWords);
+  uint32_t cost;
+  ASSERT_TRUE(pool.Adopt(1, 5, words.data(), &cost));
+  EXPECT_EQ(2U, cost);
+  EXPECT_EQ(Shifted(0), words);
+}
+
+TEST(ElitePoolTest, ReadsAreNeverTorn) {
+  ElitePool pool(2, kNumWords, Topology::Ring);
+  std::atomic<bool> done(false);
+  // Publishes ever better states, shifted by their cost.
+  std::thread writer([&]() {
+    for (uint32_t cost = 100000; cost > 0; cost--) {
+      pool.Publish(0, Shifted(cost % 50).data(), cost);
+    }
+    done = true;
+  });
+  std::vector<uint32_t> words(kNumWords);
+  uint32_t cost;
+  while (!done) {
+    if (pool.Adopt(1, ~0U, words.data(), &cost)) {
+      ASSERT_EQ(Shifted(cost % 50), words);
+    }
+  }
+  writer.join();
+}
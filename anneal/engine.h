@@ -0,0 +1,227 @@
+#ifndef ANNEAL_ENGINE_H_
+#define ANNEAL_ENGINE_H_
+
+#include <algorithm>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "schedule.h"
+
+namespace anneal {
+
+// Phases of an annealing step, for observers that time them.
+enum class Phase { Propose, Cost, Accept, Copy };
+
+// Observer of an attempt that only wants the outcome. See Annealer for what
+// an observer provides.
+struct NullObserver {
+  struct Scope {
+    Scope(NullObserver *observer, Phase phase) {}
+  };
+
+  bool stopped() const { return false; }
+  template <typename Annealer>
+  void OnStage(const Annealer &annealer) {}
+  template <typename Annealer, typename Move>
+  void OnStep(const Annealer &annealer, const Move &move, float cost,
+              bool accepted) {}
+  template <typename Annealer>
+  void OnSolved(const Annealer &annealer) {}
+  template <typename Annealer>
+  void OnReheat(const Annealer &annealer) {}
+  template <typename Annealer>
+  void OnStageEnd(Annealer *annealer, uint64_t accepted, uint64_t rejected) {}
+};
+
+// One simulated annealing attempt on a problem policy. Everything is a
+// template parameter, so the policy's calls are resolved at compile time and
+// inline into the step loop.
+//
+// A Problem provides:
+//   typedef ... State;
+//   // Whatever Undo needs to revert a move.
+//   typedef ... Move;
+//   // Applies a random move to *state, drawing from *rng.
+//   template <typename Random>
+//   Move Propose(State *state, Random *rng) const;
+//   // Non-negative, and zero only for a solution.
+//   float Cost(const State &state) const;
+//   // Reverts the move that Propose just applied.
+//   void Undo(State *state, const Move &move) const;
+//
+// Random provides Uniform(), in [0, 1), besides whatever Propose draws.
+//
+// An Observer provides stopped(), which ends the attempt when true, and the
+// hooks of NullObserver, all called on the attempt's thread:
+//   Scope: constructed as Scope(observer, phase) around each phase of a step.
+//   OnStage: when a temperature stage begins.
+//   OnStep: after the acceptance decision on a proposal of cost `cost`,
+//       before the annealer moves on. annealer.cost() is still the cost
+//       before the proposal.
+//   OnSolved: when the attempt reaches cost zero, unless already stopped.
+//   OnReheat: when the schedule has reheated and the annealer has returned to
+//       its best state.
+//   OnStageEnd: after each stage, with the counts of the stage. The observer
+//       may replace the state with Adopt.
+template <typename Problem, typename Random, typename Observer>
+class Annealer {
+ public:
+  typedef typename Problem::State State;
+  typedef typename Problem::Move Move;
+
+  // Keeps the best state seen if track_best is set or the schedule is
+  // adaptive, whose reheats return to it.
+  Annealer(const Problem &problem, const State &state, Random *rng,
+           CoolingSchedule *schedule, Observer *observer,
+           bool track_best = false)
+      : problem_(problem),
+        rng_(rng),
+        schedule_(schedule),
+        observer_(observer),
+        track_best_(track_best || schedule->adaptive()),
+        state_(state),
+        cost_(problem.Cost(state)),
+        best_(state),
+        best_cost_(cost_),
+        min_cost_(cost_),
+        num_steps_(0),
+        stage_steps_(0),
+        num_reheats_(0),
+        solved_(false) {}
+
+  // Continues an attempt that had taken num_steps steps, the last
+  // stage_steps of them in the stage it was stopped in, and reached min_cost
+  // before it was checkpointed. The stage is continued rather than started
+  // over, so that with the geometric schedule the resumed attempt takes the
+  // same steps as if it had not been stopped.
+  void Resume(uint64_t num_steps, uint64_t stage_steps, float min_cost) {
+    num_steps_ = num_steps;
+    stage_steps_ = stage_steps;
+    min_cost_ = min_cost;
+  }
+
+  // Runs stages until the schedule ends, the attempt is solved or the
+  // observer stops it. Returns whether it was solved.
+  bool Run() {
+    const bool adaptive = schedule_->adaptive();
+    while (!schedule_->done() && !stopped()) {
+      const int64_t stage_length = schedule_->stage_length();
+      const float stage_min_cost = min_cost_;
+      acceptance_.SetTemperature(schedule_->temperature());
+      observer_->OnStage(*this);
+
+      uint64_t accepted = 0;
+      uint64_t rejected = 0;
+      int64_t iteration = stage_steps_;
+      for (; iteration < stage_length && !stopped(); iteration++) {
+        num_steps_++;
+        const Move move = Propose();
+        const float new_cost = Evaluate();
+        if (new_cost == 0 && !stopped()) {
+          solved_ = true;
+          observer_->OnSolved(*this);
+        }
+        const bool accept = Decide(new_cost);
+        observer_->OnStep(*this, move, new_cost, accept);
+        {
+          Scope scope(observer_, Phase::Copy);
+          if (accept) {
+            accepted++;
+            cost_ = new_cost;
+            min_cost_ = std::min(min_cost_, cost_);
+          } else {
+            rejected++;
+            problem_.Undo(&state_, move);
+          }
+        }
+        if (adaptive) {
+          schedule_->Observe(accept, cost_);
+        }
+        if (track_best_ && cost_ < best_cost_) {
+          best_ = state_;
+          best_cost_ = cost_;
+        }
+      }
+
+      if (stopped()) {
+        // The stage is continued from here if the attempt is resumed.
+        stage_steps_ = iteration;
+      } else {
+        stage_steps_ = 0;
+        if (schedule_->NextStage(min_cost_ < stage_min_cost)) {
+          state_ = best_;
+          cost_ = best_cost_;
+          num_reheats_++;
+          observer_->OnReheat(*this);
+        }
+      }
+      observer_->OnStageEnd(this, accepted, rejected);
+    }
+    return solved_;
+  }
+
+  // Continues from `state`, of cost `cost`, as the new best state, e.g. a
+  // state migrated from another attempt.
+  void Adopt(const State &state, float cost) {
+    state_ = best_ = state;
+    cost_ = best_cost_ = cost;
+    min_cost_ = std::min(min_cost_, cost_);
+  }
+
+  const State &state() const { return state_; }
+  float cost() const { return cost_; }
+  const State &best() const { return best_; }
+  float best_cost() const { return best_cost_; }
+  float min_cost() const { return min_cost_; }
+  float temperature() const { return schedule_->temperature(); }
+  const CoolingSchedule &schedule() const { return *schedule_; }
+  const Random &rng() const { return *rng_; }
+  uint64_t num_steps() const { return num_steps_; }
+  // Steps already taken in the current stage.
+  uint64_t stage_steps() const { return stage_steps_; }
+  uint64_t num_reheats() const { return num_reheats_; }
+  bool solved() const { return solved_; }
+
+ private:
+  typedef typename Observer::Scope Scope;
+
+  bool stopped() const { return solved_ || observer_->stopped(); }
+
+  Move Propose() {
+    Scope scope(observer_, Phase::Propose);
+    return problem_.Propose(&state_, rng_);
+  }
+
+  float Evaluate() {
+    Scope scope(observer_, Phase::Cost);
+    return problem_.Cost(state_);
+  }
+
+  bool Decide(float new_cost) {
+    Scope scope(observer_, Phase::Accept);
+    return cost_ >= new_cost ||
+           acceptance_.Probability(new_cost - cost_) > rng_->Uniform();
+  }
+
+  const Problem &problem_;
+  Random *const rng_;
+  CoolingSchedule *const schedule_;
+  Observer *const observer_;
+  const bool track_best_;
+  AcceptanceTable acceptance_;
+
+  State state_;
+  float cost_;
+  State best_;
+  float best_cost_;
+  float min_cost_;
+  uint64_t num_steps_;
+  uint64_t stage_steps_;
+  uint64_t num_reheats_;
+  bool solved_;
+};
+
+}  // namespace anneal
+
+#endif  // ANNEAL_ENGINE_H_
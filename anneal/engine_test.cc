@@ -0,0 +1,145 @@
+#include "engine.h"
+#include "gtest/gtest.h"
+
+#include <random>
+
+using anneal::Annealer;
+using anneal::CoolingSchedule;
+using anneal::NullObserver;
+using anneal::ScheduleKind;
+
+// Walks x one unit at a time towards 17.
+struct WalkProblem {
+  typedef int State;
+  typedef int Move;
+
+  template <typename Random>
+  Move Propose(int *x, Random *rng) const {
+    int step = rng->Below(2) ? 1 : -1;
+    *x += step;
+    return step;
+  }
+
+  float Cost(const int &x) const { return abs(x - 17); }
+
+  void Undo(int *x, const Move &step) const { *x -= step; }
+};
+
+class TestRandom {
+ public:
+  explicit TestRandom(uint32_t seed) : engine_(seed) {}
+  size_t Below(size_t n) { return engine_() % n; }
+  double Uniform() { return std::uniform_real_distribution<>(0, 1)(engine_); }
+
+ private:
+  std::mt19937 engine_;
+};
+
+// Checks that the annealer's cost always matches its state, and records what
+// it saw.
+struct CheckingObserver : NullObserver {
+  typedef Annealer<WalkProblem, TestRandom, CheckingObserver> Walk;
+
+  struct Scope {
+    Scope(CheckingObserver *observer, anneal::Phase phase) {}
+  };
+
+  bool stopped() const { return max_steps > 0 && num_steps >= max_steps; }
+
+  void OnStep(const Walk &walk, int step, float cost, bool accepted) {
+    num_steps++;
+    num_accepted += accepted;
+    EXPECT_EQ(WalkProblem().Cost(walk.state() - step), walk.cost());
+  }
+  void OnSolved(const Walk &walk) {
+    num_solved++;
+    EXPECT_EQ(17, walk.state());
+  }
+  void OnReheat(const Walk &walk) {
+    num_reheats++;
+    EXPECT_EQ(walk.best_cost(), walk.cost());
+  }
+  void OnStageEnd(Walk *walk, uint64_t accepted, uint64_t rejected) {
+    EXPECT_EQ(WalkProblem().Cost(walk->state()), walk->cost());
+  }
+
+  uint64_t max_steps = 0;
+  uint64_t num_steps = 0;
+  uint64_t num_accepted = 0;
+  int num_solved = 0;
+  int num_reheats = 0;
+};
+
+TEST(EngineTest, SolvesAndStops) {
+  WalkProblem problem;
+  TestRandom rng(1);
+  CoolingSchedule schedule(ScheduleKind::Geometric, 1.0, 0.01, 100, 100, 0);
+  CheckingObserver observer;
+  CheckingObserver::Walk walk(problem, 0, &rng, &schedule, &observer);
+  EXPECT_EQ(17, walk.cost());
+
+  EXPECT_TRUE(walk.Run());
+  EXPECT_TRUE(walk.solved());
+  EXPECT_EQ(17, walk.state());
+  EXPECT_EQ(1, observer.num_solved);
+  EXPECT_EQ(observer.num_steps, walk.num_steps());
+  EXPECT_FALSE(schedule.done());
+}
+
+TEST(EngineTest, RejectedMovesAreUndone) {
+  WalkProblem problem;
+  TestRandom rng(2);
+  // Cold enough that uphill moves are never accepted.
+  CoolingSchedule schedule(ScheduleKind::Geometric, 1e-3, 1e-4, 2, 10, 0);
+  CheckingObserver observer;
+  CheckingObserver::Walk walk(problem, -50, &rng, &schedule, &observer);
+
+  EXPECT_FALSE(walk.Run());
+  EXPECT_TRUE(schedule.done());
+  // Rounding of the float temperature may add a stage.
+  EXPECT_EQ(0U, walk.num_steps() % 10);
+  EXPECT_EQ(observer.num_steps, walk.num_steps());
+  EXPECT_EQ(67 - (int)observer.num_accepted, walk.cost());
+  EXPECT_EQ(walk.cost(), walk.min_cost());
+}
+
+TEST(EngineTest, ObserverStopsAttempt) {
+  WalkProblem problem;
+  TestRandom rng(3);
+  CoolingSchedule schedule(ScheduleKind::Geometric, 1.0, 0.01, 100, 100, 0);
+  CheckingObserver observer;
+  observer.max_steps = 5;
+  CheckingObserver::Walk walk(problem, 1000, &rng, &schedule, &observer);
+
+  EXPECT_FALSE(walk.Run());
+  EXPECT_EQ(5U, walk.num_steps());
+}
+
+TEST(EngineTest, ReheatsReturnToBest) {
+  WalkProblem problem;
+  TestRandom rng(4);
+  // Hot enough to wander off, and never long enough to get to 17.
+  CoolingSchedule schedule(ScheduleKind::Adaptive, 100, 50, 4, 3, 2);
+  CheckingObserver observer;
+  CheckingObserver::Walk walk(problem, 1000, &rng, &schedule, &observer);
+
+  EXPECT_FALSE(walk.Run());
+  EXPECT_EQ(2, observer.num_reheats);
+  EXPECT_EQ(2U, walk.num_reheats());
+  EXPECT_LE(walk.best_cost(), walk.cost());
+}
+
+TEST(EngineTest, AdoptReplacesCurrentAndBest) {
+  WalkProblem problem;
+  TestRandom rng(5);
+  CoolingSchedule schedule(ScheduleKind::Geometric, 1.0, 0.01, 100, 100, 0);
+  NullObserver observer;
+  Annealer<WalkProblem, TestRandom, NullObserver> walk(problem, 100, &rng,
+                                                       &schedule, &observer);
+  walk.Adopt(20, 3);
+  EXPECT_EQ(20, walk.state());
+  EXPECT_EQ(20, walk.best());
+  EXPECT_EQ(3, walk.cost());
+  EXPECT_EQ(3, walk.min_cost());
+  EXPECT_TRUE(walk.Run());
+}
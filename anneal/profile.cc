@@ -0,0 +1,157 @@
+#include "profile.h"
+
+#ifdef ANNEAL_PROFILE
+
+#include <iomanip>
+
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+namespace anneal {
+
+static const char *const kPhaseNames[kNumPhases] = {"propose", "cost",
+                                                    "accept", "copy"};
+
+PerfCounters::~PerfCounters() {
+  if (group_fd_ < 0) {
+    return;
+  }
+  for (size_t i = 0; i < kNumCounters; i++) {
+    close(fds_[i]);
+  }
+}
+
+bool PerfCounters::Open() {
+#ifdef __linux__
+  static const uint64_t kConfigs[kNumCounters] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+  for (size_t i = 0; i < kNumCounters; i++) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = kConfigs[i];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    int fd = syscall(__NR_perf_event_open, &attr, 0, -1,
+                     i == 0 ? -1 : fds_[0], 0);
+    if (fd < 0) {
+      for (size_t j = 0; j < i; j++) {
+        close(fds_[j]);
+      }
+      return false;
+    }
+    fds_[i] = fd;
+  }
+  group_fd_ = fds_[0];
+  ioctl(group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return true;
+#else
+  return false;
+#endif
+}
+
+void PerfCounters::Read(uint64_t (&values)[kNumCounters]) const {
+  // PERF_FORMAT_GROUP: the number of counters followed by their values.
+  uint64_t buffer[1 + kNumCounters];
+  if (read(group_fd_, buffer, sizeof(buffer)) != sizeof(buffer)) {
+    memset(values, 0, sizeof(values));
+    return;
+  }
+  memcpy(values, buffer + 1, sizeof(values));
+}
+
+PhaseProfile::PhaseProfile() : has_counters_(false) {
+  memset(count_, 0, sizeof(count_));
+  memset(ticks_, 0, sizeof(ticks_));
+  memset(histogram_, 0, sizeof(histogram_));
+  memset(counters_, 0, sizeof(counters_));
+}
+
+void PhaseProfile::Add(
+    Phase phase, uint64_t ticks,
+    const uint64_t (&counter_deltas)[PerfCounters::kNumCounters]) {
+  size_t index = static_cast<size_t>(phase);
+  size_t bucket = ticks == 0 ? 0 : 64 - __builtin_clzll(ticks);
+  count_[index]++;
+  ticks_[index] += ticks;
+  histogram_[index][bucket < kNumBuckets ? bucket : kNumBuckets - 1]++;
+  if (perf_.is_open()) {
+    has_counters_ = true;
+    for (size_t i = 0; i < PerfCounters::kNumCounters; i++) {
+      counters_[index][i] += counter_deltas[i];
+    }
+  }
+}
+
+void PhaseProfile::Merge(const PhaseProfile &other) {
+  for (size_t phase = 0; phase < kNumPhases; phase++) {
+    count_[phase] += other.count_[phase];
+    ticks_[phase] += other.ticks_[phase];
+    for (size_t bucket = 0; bucket < kNumBuckets; bucket++) {
+      histogram_[phase][bucket] += other.histogram_[phase][bucket];
+    }
+    for (size_t i = 0; i < PerfCounters::kNumCounters; i++) {
+      counters_[phase][i] += other.counters_[phase][i];
+    }
+  }
+  has_counters_ |= other.has_counters_;
+}
+
+std::ostream &PhaseProfile::Dump(std::ostream &os) const {
+  uint64_t total_ticks = 0;
+  for (size_t phase = 0; phase < kNumPhases; phase++) {
+    total_ticks += ticks_[phase];
+  }
+
+  os << "Phase      calls        share  mean     p50      p99      (ticks)";
+  if (has_counters_) {
+    os << "  cycles     instrs     cache-miss branch-miss (per call)";
+  }
+  os << std::endl;
+  for (size_t phase = 0; phase < kNumPhases; phase++) {
+    uint64_t count = count_[phase];
+    if (count == 0) {
+      continue;
+    }
+    // Percentiles are reported as the upper bound of their log2 bucket.
+    uint64_t p50 = 0, p99 = 0, seen = 0;
+    for (size_t bucket = 0; bucket < kNumBuckets; bucket++) {
+      seen += histogram_[phase][bucket];
+      if (p50 == 0 && seen * 2 >= count) {
+        p50 = 1ULL << bucket;
+      }
+      if (p99 == 0 && seen * 100 >= count * 99) {
+        p99 = 1ULL << bucket;
+      }
+    }
+    os << std::left << std::setw(11) << kPhaseNames[phase] << std::setw(13)
+       << count << std::setw(7) << std::fixed << std::setprecision(3)
+       << (double)ticks_[phase] / total_ticks << std::setw(9)
+       << std::setprecision(1) << (double)ticks_[phase] / count
+       << std::setw(9) << p50 << std::setw(9) << p99;
+    if (has_counters_) {
+      os << "         ";
+      for (size_t i = 0; i < PerfCounters::kNumCounters; i++) {
+        os << std::setw(11) << (double)counters_[phase][i] / count;
+      }
+    }
+    os << std::endl;
+  }
+  os.unsetf(std::ios::floatfield | std::ios::adjustfield);
+  return os << std::setprecision(6);
+}
+
+}  // namespace anneal
+
+#endif  // ANNEAL_PROFILE
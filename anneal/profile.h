@@ -0,0 +1,134 @@
+#ifndef ANNEAL_PROFILE_H_
+#define ANNEAL_PROFILE_H_
+
+#include <ostream>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef ANNEAL_PROFILE
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+#include "engine.h"
+
+namespace anneal {
+
+#ifdef ANNEAL_PROFILE
+
+static constexpr size_t kNumPhases = 4;
+
+// Hardware counters read around each phase when --perf_counters is set.
+// Reading them costs a system call per phase, so the TSC timings of a run
+// with counters are inflated accordingly.
+class PerfCounters {
+ public:
+  enum Counter { Cycles, Instructions, CacheMisses, BranchMisses };
+  static constexpr size_t kNumCounters = 4;
+
+  PerfCounters() : group_fd_(-1) {}
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+  ~PerfCounters();
+
+  // Opens the counters for the calling thread. Returns false if
+  // perf_event_open is unavailable or not permitted.
+  bool Open();
+  bool is_open() const { return group_fd_ >= 0; }
+  void Read(uint64_t (&values)[kNumCounters]) const;
+
+ private:
+  int group_fd_;
+  int fds_[kNumCounters];
+};
+
+// Per-thread phase timings. Durations are kept in histograms bucketed by
+// log2 of the elapsed TSC ticks; threads merge theirs into Stats when done.
+class PhaseProfile {
+ public:
+  static constexpr size_t kNumBuckets = 48;
+
+  PhaseProfile();
+
+  // Enables hardware counters for the calling thread. Returns false if they
+  // are not available.
+  bool EnablePerfCounters() { return perf_.Open(); }
+  const PerfCounters &perf() const { return perf_; }
+
+  void Add(Phase phase, uint64_t ticks,
+           const uint64_t (&counter_deltas)[PerfCounters::kNumCounters]);
+  void Merge(const PhaseProfile &other);
+
+  std::ostream &Dump(std::ostream &os) const;
+
+  static uint64_t ReadTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+  }
+
+ private:
+  uint64_t count_[kNumPhases];
+  uint64_t ticks_[kNumPhases];
+  uint64_t histogram_[kNumPhases][kNumBuckets];
+  uint64_t counters_[kNumPhases][PerfCounters::kNumCounters];
+  bool has_counters_;
+  PerfCounters perf_;
+};
+
+// Attributes the time until the end of the enclosing scope to a phase.
+class ScopedPhase {
+ public:
+  ScopedPhase(PhaseProfile *profile, Phase phase)
+      : profile_(profile), phase_(phase) {
+    if (profile_->perf().is_open()) {
+      profile_->perf().Read(start_counters_);
+    }
+    start_ = PhaseProfile::ReadTsc();
+  }
+
+  ~ScopedPhase() {
+    uint64_t ticks = PhaseProfile::ReadTsc() - start_;
+    uint64_t deltas[PerfCounters::kNumCounters] = {0};
+    if (profile_->perf().is_open()) {
+      profile_->perf().Read(deltas);
+      for (size_t i = 0; i < PerfCounters::kNumCounters; i++) {
+        deltas[i] -= start_counters_[i];
+      }
+    }
+    profile_->Add(phase_, ticks, deltas);
+  }
+
+ private:
+  PhaseProfile *profile_;
+  Phase phase_;
+  uint64_t start_;
+  uint64_t start_counters_[PerfCounters::kNumCounters];
+};
+
+#else  // ANNEAL_PROFILE
+
+// Profiling compiled out: empty types that the optimizer removes entirely.
+class PhaseProfile {
+ public:
+  bool EnablePerfCounters() { return false; }
+  void Merge(const PhaseProfile &other) {}
+  std::ostream &Dump(std::ostream &os) const { return os; }
+};
+
+class ScopedPhase {
+ public:
+  ScopedPhase(PhaseProfile *profile, Phase phase) {}
+};
+
+#endif  // ANNEAL_PROFILE
+
+}  // namespace anneal
+
+#endif  // ANNEAL_PROFILE_H_
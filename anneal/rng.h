@@ -0,0 +1,72 @@
+#ifndef ANNEAL_RNG_H_
+#define ANNEAL_RNG_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace anneal {
+
+// xoshiro256** generator with 32 bytes of state. Each attempt gets its own
+// stream derived from (seed, attempt), so a run can be reproduced from its
+// seed no matter how attempts are scheduled onto threads.
+class Rng {
+ public:
+  using result_type = uint64_t;
+
+  struct State {
+    uint64_t s[4];
+  };
+
+  Rng(uint64_t seed, uint64_t stream) {
+    uint64_t x = seed ^ (stream * 0xd1342543de82ef95ULL);
+    for (auto &word : state_.s) {
+      word = SplitMix64(&x);
+    }
+  }
+  explicit Rng(const State &state) : state_(state) {}
+
+  const State &state() const { return state_; }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return ~0ULL; }
+
+  result_type operator()() {
+    uint64_t *s = state_.s;
+    const uint64_t result = Rotl(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = Rotl(s[3], 45);
+    return result;
+  }
+
+  // Uniform integer in [0, n) by multiply-shift. There is no rejection loop;
+  // the bias is below n / 2^64.
+  size_t Below(size_t n) {
+    return (size_t)(((unsigned __int128)(*this)() * n) >> 64);
+  }
+
+  bool Bit() { return (*this)() >> 63; }
+
+  // Uniform double in [0, 1).
+  double Uniform() { return ((*this)() >> 11) * (1.0 / (1ULL << 53)); }
+
+ private:
+  static uint64_t Rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+  static uint64_t SplitMix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  State state_;
+};
+
+}  // namespace anneal
+
+#endif  // ANNEAL_RNG_H_
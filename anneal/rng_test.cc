@@ -0,0 +1,49 @@
+#include "rng.h"
+#include "gtest/gtest.h"
+
+using anneal::Rng;
+
+TEST(RngTest, SameSeedAndStreamReproduce) {
+  Rng a(42, 7);
+  Rng b(42, 7);
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(a(), b());
+  }
+}
+
+TEST(RngTest, StreamsDiffer) {
+  Rng a(42, 0);
+  Rng b(42, 1);
+  EXPECT_NE(a(), b());
+}
+
+TEST(RngTest, StateRoundTrip) {
+  Rng a(1, 2);
+  a();
+  Rng b(a.state());
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(a(), b());
+  }
+}
+
+TEST(RngTest, BelowCoversRange) {
+  Rng rng(3, 0);
+  int counts[5] = {0};
+  for (int i = 0; i < 5000; i++) {
+    size_t value = rng.Below(5);
+    ASSERT_LT(value, 5UL);
+    counts[value]++;
+  }
+  for (int count : counts) {
+    EXPECT_GT(count, 800);
+  }
+}
+
+TEST(RngTest, UniformInUnitInterval) {
+  Rng rng(4, 0);
+  for (int i = 0; i < 1000; i++) {
+    double value = rng.Uniform();
+    EXPECT_GE(value, 0.0);
+    EXPECT_LT(value, 1.0);
+  }
+}
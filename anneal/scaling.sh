@@ -0,0 +1,46 @@
+#!/bin/bash
+# Reports how the throughput of a solver scales with its number of threads.
+#
+# Usage: scaling.sh <solver> [solver flags...]
+#
+# Runs `<solver> --pin_threads --num_threads=<n> --num_attempts=<n>` for
+# n = 1, 2, 4, ... up to $MAX_THREADS (128 by default), so that every thread
+# runs exactly one attempt, and prints for each n the accepted plus rejected
+# configs per second of wall time, the speedup over one thread and the
+# scaling efficiency, i.e. the speedup divided by n. Flags given after the
+# solver override these, e.g. --seed or --annealing_steps. Solvers run under
+# `bazel run` need an absolute path.
+
+set -e
+
+if [ $# -lt 1 ]; then
+  echo "Usage: $0 <solver> [solver flags...]" >&2
+  exit 1
+fi
+solver="$1"
+shift
+max_threads="${MAX_THREADS:-128}"
+
+printf "%8s %10s %14s %8s %11s\n" threads seconds "configs/s" speedup \
+  efficiency
+base=""
+for ((n = 1; n <= max_threads; n *= 2)); do
+  begin=$(date +%s.%N)
+  # The exit code only tells whether the board was solved.
+  output=$("$solver" --pin_threads --num_threads="$n" --num_attempts="$n" \
+    --stats_interval_seconds=0 --seed=1 "$@" 2>&1) || true
+  end=$(date +%s.%N)
+  # The last counters printed are the totals over every socket.
+  configs=$(echo "$output" | awk '
+    /^Accepted configs:/ { accepted = $3 }
+    /^Rejected configs:/ { rejected = $3 }
+    END { print accepted + rejected }')
+  throughput=$(awk -v c="$configs" -v b="$begin" -v e="$end" \
+    'BEGIN { printf "%.0f", c / (e - b) }')
+  if [ -z "$base" ]; then
+    base="$throughput"
+  fi
+  awk -v n="$n" -v b="$begin" -v e="$end" -v t="$throughput" -v base="$base" \
+    'BEGIN { printf "%8d %10.2f %14d %8.2f %10.1f%%\n", n, e - b, t,
+             t / base, 100 * t / base / n }'
+done
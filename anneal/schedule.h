@@ -0,0 +1,180 @@
+#ifndef ANNEAL_SCHEDULE_H_
+#define ANNEAL_SCHEDULE_H_
+
+#include <algorithm>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace anneal {
+
+// Metropolis acceptance probabilities exp(-delta / T) for integer cost
+// increases. Costs in the solvers are small integers, so one exp() per
+// temperature stage plus a table of its powers replaces one exp() per step.
+class AcceptanceTable {
+ public:
+  static constexpr size_t kSize = 64;
+
+  void SetTemperature(double T) {
+    base_ = exp(-1.0 / T);
+    table_[0] = 1.0;
+    for (size_t delta = 1; delta < kSize; delta++) {
+      table_[delta] = table_[delta - 1] * base_;
+    }
+  }
+
+  double Probability(size_t delta) const {
+    return delta < kSize ? table_[delta] : pow(base_, delta);
+  }
+
+ private:
+  double base_;
+  double table_[kSize];
+};
+
+enum class ScheduleKind { Geometric, Adaptive };
+
+// Position of an attempt in its schedule, kept in checkpoints.
+struct ScheduleState {
+  float temperature;
+  // Temperature of the stage in which the best cost so far was reached.
+  float best_temperature;
+  uint32_t stage_length;
+  uint32_t num_reheats;
+  uint32_t stagnant_stages;
+};
+
+// Temperature and number of steps of each annealing stage.
+//
+// The geometric schedule multiplies the temperature by a constant alpha after
+// max_tries steps, from t_max down to t_min.
+//
+// The adaptive schedule watches the acceptance ratio and the variance of the
+// cost within each stage. Hot stages, where nearly every move is accepted,
+// are cut short and cooled twice as fast; stages where the cost fluctuates
+// strongly, near the transition into the low-cost states, are lengthened up
+// to twofold. When the best cost has not improved for a tenth of the
+// schedule while the chain is frozen, or when the schedule runs out, the
+// attempt is reheated and continues from its best state rather than ending,
+// up to max_reheats times.
+class CoolingSchedule {
+ public:
+  CoolingSchedule(ScheduleKind kind, double t_max, double t_min,
+                  int32_t annealing_steps, int64_t max_tries,
+                  int32_t max_reheats)
+      : kind_(kind),
+        t_max_(t_max),
+        t_min_(t_min),
+        alpha_(exp(log(t_min / t_max) / annealing_steps)),
+        max_tries_(max_tries),
+        max_reheats_(max_reheats),
+        plateau_stages_(std::max(2, annealing_steps / 10)) {
+    state_.temperature = t_max;
+    state_.best_temperature = t_max;
+    state_.stage_length = max_tries;
+    state_.num_reheats = 0;
+    state_.stagnant_stages = 0;
+    ResetStage();
+  }
+
+  // Continues from a checkpointed state.
+  void Restore(const ScheduleState &state) {
+    state_ = state;
+    ResetStage();
+  }
+
+  const ScheduleState &state() const { return state_; }
+  bool adaptive() const { return kind_ == ScheduleKind::Adaptive; }
+  float temperature() const { return state_.temperature; }
+  int64_t stage_length() const { return state_.stage_length; }
+  bool done() const { return !(state_.temperature > t_min_); }
+
+  // Records the outcome of a step of the current stage. Only needed by the
+  // adaptive schedule.
+  void Observe(bool accepted, float cost) {
+    stage_steps_++;
+    stage_accepted_ += accepted;
+    cost_sum_ += cost;
+    cost_sum_squares_ += (double)cost * cost;
+  }
+
+  // Moves on to the next stage. `improved` tells whether the best cost of the
+  // attempt went down during the stage that just ended. Returns true if the
+  // attempt has been reheated and should continue from its best state.
+  bool NextStage(bool improved) {
+    if (!adaptive()) {
+      state_.temperature = state_.temperature * alpha_;
+      return false;
+    }
+
+    double acceptance = 0, deviation = 0;
+    if (stage_steps_ > 0) {
+      acceptance = (double)stage_accepted_ / stage_steps_;
+      double mean = cost_sum_ / stage_steps_;
+      deviation = sqrt(
+          std::max(0.0, cost_sum_squares_ / stage_steps_ - mean * mean));
+    }
+    if (improved) {
+      state_.best_temperature = state_.temperature;
+      state_.stagnant_stages = 0;
+    } else {
+      state_.stagnant_stages++;
+    }
+
+    float next = state_.temperature * alpha_;
+    if (acceptance > kHotAcceptance) {
+      next *= alpha_;
+      state_.stage_length = std::max<int64_t>(1, max_tries_ / 2);
+    } else {
+      state_.stage_length =
+          llround(max_tries_ * std::min(2.0, 1 + deviation / 2));
+    }
+    ResetStage();
+
+    bool stagnant = state_.stagnant_stages >= plateau_stages_ &&
+                    acceptance < kFrozenAcceptance;
+    if ((stagnant || !(next > t_min_)) &&
+        state_.num_reheats < (uint32_t)max_reheats_) {
+      // Back up twice the plateau length above where the best state was
+      // found.
+      state_.num_reheats++;
+      state_.stagnant_stages = 0;
+      state_.temperature = std::min<double>(
+          t_max_, state_.best_temperature / pow(alpha_, 2 * plateau_stages_));
+      state_.stage_length = max_tries_;
+      return true;
+    }
+    state_.temperature = next;
+    return false;
+  }
+
+ private:
+  static constexpr double kHotAcceptance = 0.8;
+  static constexpr double kFrozenAcceptance = 0.05;
+
+  void ResetStage() {
+    stage_steps_ = 0;
+    stage_accepted_ = 0;
+    cost_sum_ = 0;
+    cost_sum_squares_ = 0;
+  }
+
+  const ScheduleKind kind_;
+  const double t_max_;
+  const double t_min_;
+  const double alpha_;
+  const int64_t max_tries_;
+  const int32_t max_reheats_;
+  const uint32_t plateau_stages_;
+
+  ScheduleState state_;
+  uint64_t stage_steps_;
+  uint64_t stage_accepted_;
+  double cost_sum_;
+  double cost_sum_squares_;
+};
+
+}  // namespace anneal
+
+#endif  // ANNEAL_SCHEDULE_H_
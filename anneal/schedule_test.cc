@@ -0,0 +1,85 @@
+#include "schedule.h"
+#include "gtest/gtest.h"
+
+#include <math.h>
+
+using anneal::AcceptanceTable;
+using anneal::CoolingSchedule;
+using anneal::ScheduleKind;
+
+TEST(ScheduleTest, GeometricRunsAnnealingSteps) {
+  CoolingSchedule schedule(ScheduleKind::Geometric, 1.0, 0.001, 50, 24, 4);
+  int num_stages = 0;
+  float previous = 2;
+  while (!schedule.done()) {
+    EXPECT_LT(schedule.temperature(), previous);
+    EXPECT_EQ(24, schedule.stage_length());
+    previous = schedule.temperature();
+    EXPECT_FALSE(schedule.NextStage(false));
+    num_stages++;
+  }
+  // Rounding of the float temperature may add or drop the last stage.
+  EXPECT_NEAR(50, num_stages, 1);
+}
+
+TEST(ScheduleTest, AdaptiveShortensHotStages) {
+  CoolingSchedule schedule(ScheduleKind::Adaptive, 1.0, 0.001, 50, 24, 4);
+  for (int i = 0; i < 24; i++) {
+    schedule.Observe(true, 10 + i % 2);
+  }
+  EXPECT_FALSE(schedule.NextStage(true));
+  EXPECT_EQ(12, schedule.stage_length());
+  // Cooled by alpha twice.
+  EXPECT_NEAR(pow(0.001, 2.0 / 50), schedule.temperature(), 1e-6);
+}
+
+TEST(ScheduleTest, AdaptiveLengthensFluctuatingStages) {
+  CoolingSchedule schedule(ScheduleKind::Adaptive, 1.0, 0.001, 50, 24, 4);
+  for (int i = 0; i < 24; i++) {
+    schedule.Observe(i % 4 == 0, i % 2 == 0 ? 2 : 6);
+  }
+  EXPECT_FALSE(schedule.NextStage(true));
+  // A standard deviation of 2 doubles the stage.
+  EXPECT_EQ(48, schedule.stage_length());
+}
+
+TEST(ScheduleTest, AdaptiveReheatsOnPlateau) {
+  CoolingSchedule schedule(ScheduleKind::Adaptive, 1.0, 0.001, 50, 24, 2);
+  EXPECT_FALSE(schedule.NextStage(true));
+  float best_temperature = schedule.state().best_temperature;
+  int num_reheats = 0;
+  for (int stage = 0; stage < 1000 && !schedule.done(); stage++) {
+    for (int i = 0; i < 24; i++) {
+      schedule.Observe(false, 3);
+    }
+    if (schedule.NextStage(false)) {
+      num_reheats++;
+      EXPECT_GE(schedule.temperature(), best_temperature);
+      EXPECT_EQ(0U, schedule.state().stagnant_stages);
+    }
+  }
+  EXPECT_EQ(2, num_reheats);
+  EXPECT_EQ(2U, schedule.state().num_reheats);
+  EXPECT_TRUE(schedule.done());
+}
+
+TEST(ScheduleTest, RestoreContinuesFromState) {
+  CoolingSchedule schedule(ScheduleKind::Adaptive, 1.0, 0.001, 50, 24, 4);
+  schedule.NextStage(false);
+  schedule.NextStage(false);
+  CoolingSchedule restored(ScheduleKind::Adaptive, 1.0, 0.001, 50, 24, 4);
+  restored.Restore(schedule.state());
+  EXPECT_EQ(schedule.temperature(), restored.temperature());
+  EXPECT_EQ(schedule.stage_length(), restored.stage_length());
+  EXPECT_EQ(2U, restored.state().stagnant_stages);
+}
+
+TEST(AcceptanceTableTest, MatchesExp) {
+  AcceptanceTable acceptance;
+  acceptance.SetTemperature(0.37);
+  EXPECT_DOUBLE_EQ(1.0, acceptance.Probability(0));
+  for (size_t delta : {1UL, 2UL, 10UL, 63UL, 64UL, 100UL}) {
+    EXPECT_NEAR(exp(-(double)delta / 0.37), acceptance.Probability(delta),
+                1e-12);
+  }
+}
@@ -0,0 +1,151 @@
+#include "shared_run.h"
+
+#include <iostream>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace anneal {
+
+static const char kMagic[4] = {'A', 'N', 'S', 'R'};
+static const uint32_t kVersion = 1;
+
+/* static */
+std::unique_ptr<SharedRun> SharedRun::Create(const std::string &name,
+                                             uint64_t fingerprint,
+                                             size_t solution_size) {
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0 && errno == EEXIST) {
+    // Taking it over would cut off the run that owns it from its workers.
+    std::cerr << "Shared memory " << name << " already exists: another "
+              << "--serve run on this host may be using it. Pick another "
+              << "--shm_name, or remove /dev/shm" << name
+              << " if it was left behind by a run that crashed." << std::endl;
+    return nullptr;
+  }
+  if (fd < 0) {
+    std::cerr << "Could not create shared memory " << name << ": "
+              << strerror(errno) << std::endl;
+    return nullptr;
+  }
+  size_t size = SegmentSize(solution_size);
+  void *data = MAP_FAILED;
+  if (ftruncate(fd, size) == 0) {
+    data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (data == MAP_FAILED) {
+    std::cerr << "Could not map shared memory " << name << ": "
+              << strerror(errno) << std::endl;
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+
+  // A fresh segment is zeroed, which is a valid state for the atomics. The
+  // magic goes in last so that attaching processes never see a half
+  // initialized header.
+  Header *header = static_cast<Header *>(data);
+  header->version = kVersion;
+  header->fingerprint = fingerprint;
+  header->solution_size = solution_size;
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(header->magic, kMagic, sizeof(kMagic));
+  return std::unique_ptr<SharedRun>(new SharedRun(name, data, size, true));
+}
+
+/* static */
+std::unique_ptr<SharedRun> SharedRun::Attach(const std::string &name,
+                                             uint64_t fingerprint,
+                                             size_t solution_size) {
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    std::cerr << "Could not open shared memory " << name << ": "
+              << strerror(errno) << std::endl;
+    return nullptr;
+  }
+  size_t size = SegmentSize(solution_size);
+  struct stat st;
+  void *data = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && (size_t)st.st_size == size) {
+    data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (data == MAP_FAILED) {
+    std::cerr << "Shared memory " << name
+              << " does not belong to a run of this configuration."
+              << std::endl;
+    return nullptr;
+  }
+
+  std::unique_ptr<SharedRun> run(new SharedRun(name, data, size, false));
+  const Header *header = run->header_;
+  bool valid = memcmp(header->magic, kMagic, sizeof(kMagic)) == 0;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (!valid || header->version != kVersion ||
+      header->fingerprint != fingerprint ||
+      header->solution_size != solution_size) {
+    std::cerr << "Shared memory " << name
+              << " does not belong to a run of this configuration."
+              << std::endl;
+    return nullptr;
+  }
+  return run;
+}
+
+SharedRun::SharedRun(const std::string &name, void *data, size_t size,
+                     bool owner)
+    : name_(name),
+      data_(data),
+      size_(size),
+      owner_(owner),
+      header_(static_cast<Header *>(data)) {}
+
+SharedRun::~SharedRun() {
+  munmap(data_, size_);
+  if (owner_) {
+    shm_unlink(name_.c_str());
+  }
+}
+
+bool SharedRun::PublishSolution(const std::vector<uint32_t> &solution) {
+  uint32_t expected = kRunning;
+  if (solution.size() != header_->solution_size ||
+      !header_->state.compare_exchange_strong(expected, kClaimed,
+                                              std::memory_order_acq_rel)) {
+    return false;
+  }
+  for (size_t i = 0; i < solution.size(); i++) {
+    this->solution()[i].store(solution[i], std::memory_order_relaxed);
+  }
+  header_->state.store(kSolved, std::memory_order_release);
+  return true;
+}
+
+bool SharedRun::ReadSolution(std::vector<uint32_t> *solution) const {
+  if (header_->state.load(std::memory_order_acquire) != kSolved) {
+    return false;
+  }
+  solution->resize(header_->solution_size);
+  for (size_t i = 0; i < solution->size(); i++) {
+    (*solution)[i] = this->solution()[i].load(std::memory_order_relaxed);
+  }
+  return true;
+}
+
+void SharedRun::AddCounters(const Counters &delta) {
+  header_->attempts.fetch_add(delta.attempts, std::memory_order_relaxed);
+  header_->accepted.fetch_add(delta.accepted, std::memory_order_relaxed);
+  header_->rejected.fetch_add(delta.rejected, std::memory_order_relaxed);
+}
+
+SharedRun::Counters SharedRun::counters() const {
+  return Counters{header_->attempts.load(std::memory_order_relaxed),
+                  header_->accepted.load(std::memory_order_relaxed),
+                  header_->rejected.load(std::memory_order_relaxed)};
+}
+
+}  // namespace anneal
@@ -0,0 +1,91 @@
+#ifndef ANNEAL_SHARED_RUN_H_
+#define ANNEAL_SHARED_RUN_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace anneal {
+
+// State of a run shared by all solver processes on a host through a POSIX
+// shared memory segment: whether the run is solved, the solution, and
+// counters aggregated over every process of the run.
+//
+// The segment is laid out as a Header followed by solution_size uint32_t
+// words. Everything in it is accessed through lock-free atomics, so
+// processes never block on each other and a crashed process cannot leave it
+// locked.
+class SharedRun {
+ public:
+  struct Counters {
+    uint64_t attempts;
+    uint64_t accepted;
+    uint64_t rejected;
+  };
+
+  // Creates the segment `name` (e.g. "/nq"). Returns nullptr (and reports
+  // why on stderr) if it exists already, whether another run owns it or a
+  // crashed one left it behind. The segment is unlinked when the creator
+  // goes away.
+  static std::unique_ptr<SharedRun> Create(const std::string &name,
+                                           uint64_t fingerprint,
+                                           size_t solution_size);
+  // Attaches to a segment created by another process. Returns nullptr (and
+  // reports why on stderr) if it does not exist or belongs to a run with a
+  // different configuration.
+  static std::unique_ptr<SharedRun> Attach(const std::string &name,
+                                           uint64_t fingerprint,
+                                           size_t solution_size);
+  ~SharedRun();
+
+  bool solved() const {
+    return header_->state.load(std::memory_order_acquire) != kRunning;
+  }
+
+  // Marks the run solved with `solution`. Only the first solution is kept;
+  // returns false for every later one.
+  bool PublishSolution(const std::vector<uint32_t> &solution);
+  // Returns false if no solution has been published, or if it is still
+  // being written.
+  bool ReadSolution(std::vector<uint32_t> *solution) const;
+
+  void AddCounters(const Counters &delta);
+  Counters counters() const;
+
+ private:
+  enum State : uint32_t { kRunning, kClaimed, kSolved };
+
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t fingerprint;
+    uint64_t solution_size;
+    std::atomic<uint32_t> state;
+    std::atomic<uint64_t> attempts;
+    std::atomic<uint64_t> accepted;
+    std::atomic<uint64_t> rejected;
+  };
+
+  SharedRun(const std::string &name, void *data, size_t size, bool owner);
+
+  static size_t SegmentSize(size_t solution_size) {
+    return sizeof(Header) + solution_size * sizeof(uint32_t);
+  }
+  std::atomic<uint32_t> *solution() const {
+    return reinterpret_cast<std::atomic<uint32_t> *>(header_ + 1);
+  }
+
+  const std::string name_;
+  void *data_;
+  size_t size_;
+  bool owner_;
+  Header *header_;
+};
+
+}  // namespace anneal
+
+#endif  // ANNEAL_SHARED_RUN_H_
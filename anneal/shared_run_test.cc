@@ -0,0 +1,69 @@
+#include "shared_run.h"
+#include "gtest/gtest.h"
+
+#include <unistd.h>
+
+using anneal::SharedRun;
+
+// Segment names are per process so that concurrent test runs do not clash.
+static std::string SegmentName() {
+  return "/anneal_shared_run_test_" + std::to_string(getpid());
+}
+
+TEST(SharedRunTest, AttachSeesCreatorState) {
+  auto created = SharedRun::Create(SegmentName(), 42, 4);
+  ASSERT_TRUE(created != nullptr);
+  auto attached = SharedRun::Attach(SegmentName(), 42, 4);
+  ASSERT_TRUE(attached != nullptr);
+
+  EXPECT_FALSE(attached->solved());
+  attached->AddCounters(SharedRun::Counters{1, 10, 20});
+  created->AddCounters(SharedRun::Counters{2, 30, 40});
+  SharedRun::Counters counters = created->counters();
+  EXPECT_EQ(3U, counters.attempts);
+  EXPECT_EQ(40U, counters.accepted);
+  EXPECT_EQ(60U, counters.rejected);
+}
+
+TEST(SharedRunTest, FirstSolutionWins) {
+  auto created = SharedRun::Create(SegmentName(), 42, 4);
+  ASSERT_TRUE(created != nullptr);
+  auto attached = SharedRun::Attach(SegmentName(), 42, 4);
+  ASSERT_TRUE(attached != nullptr);
+
+  std::vector<uint32_t> solution;
+  EXPECT_FALSE(created->ReadSolution(&solution));
+  EXPECT_FALSE(attached->PublishSolution({1, 2, 3}));
+  EXPECT_TRUE(attached->PublishSolution({1, 3, 0, 2}));
+  EXPECT_FALSE(created->PublishSolution({2, 0, 3, 1}));
+  EXPECT_TRUE(created->solved());
+  ASSERT_TRUE(created->ReadSolution(&solution));
+  EXPECT_EQ((std::vector<uint32_t>{1, 3, 0, 2}), solution);
+}
+
+TEST(SharedRunTest, CreateRefusesExistingSegment) {
+  auto created = SharedRun::Create(SegmentName(), 42, 4);
+  ASSERT_TRUE(created != nullptr);
+  testing::internal::CaptureStderr();
+  EXPECT_TRUE(SharedRun::Create(SegmentName(), 42, 4) == nullptr);
+  EXPECT_NE(std::string::npos,
+            testing::internal::GetCapturedStderr().find("already exists"));
+  // The first run still owns the segment.
+  auto attached = SharedRun::Attach(SegmentName(), 42, 4);
+  ASSERT_TRUE(attached != nullptr);
+  attached->AddCounters(SharedRun::Counters{1, 2, 3});
+  EXPECT_EQ(1U, created->counters().attempts);
+  created.reset();
+  EXPECT_TRUE(SharedRun::Create(SegmentName(), 42, 4) != nullptr);
+}
+
+TEST(SharedRunTest, AttachRefusesOtherRuns) {
+  EXPECT_TRUE(SharedRun::Attach(SegmentName(), 42, 4) == nullptr);
+  auto created = SharedRun::Create(SegmentName(), 42, 4);
+  ASSERT_TRUE(created != nullptr);
+  EXPECT_TRUE(SharedRun::Attach(SegmentName(), 43, 4) == nullptr);
+  EXPECT_TRUE(SharedRun::Attach(SegmentName(), 42, 5) == nullptr);
+  created.reset();
+  // The creator unlinks the segment.
+  EXPECT_TRUE(SharedRun::Attach(SegmentName(), 42, 4) == nullptr);
+}
@@ -0,0 +1,323 @@
+#ifndef ANNEAL_SOLVER_H_
+#define ANNEAL_SOLVER_H_
+
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include <stdint.h>
+#include <string.h>
+
+#include "checkpoint.h"
+#include "config.h"
+#include "elite_pool.h"
+#include "engine.h"
+#include "profile.h"
+#include "rng.h"
+#include "schedule.h"
+#include "stats.h"
+#include "trace.h"
+#include "tts.h"
+
+namespace anneal {
+
+// Attempts of a problem policy, as run by nq and atax. Besides what Annealer
+// needs, a Problem solved here provides:
+//   // The state an attempt starts from, before Randomize.
+//   State Start() const;
+//   template <typename Random>
+//   void Randomize(State *state, Random *rng) const;
+//   // States are stored as num_words() words in checkpoints, in the elite
+//   // pool and in the solution of a run.
+//   size_t num_words() const;
+//   void Encode(const State &state, uint32_t *words) const;
+//   State Decode(const uint32_t *words) const;
+//   // How a move is traced, along with its `first` and `second` members.
+//   TraceMove Kind(const Move &move) const;
+//   // Prints a solution.
+//   void Print(const State &state, std::ostream &os) const;
+//   // Tells the problem apart in fingerprints, e.g. "board_size=8".
+//   std::string Describe() const;
+
+// What an attempt reports to, beyond its own configuration.
+struct SolverContext {
+  Stats *stats = nullptr;
+  // Set by the attempt that finds a solution; every attempt stops when set.
+  volatile bool *found = nullptr;
+  // If set, the attempt keeps its resumable state in slot `slot`.
+  Checkpointer *checkpointer = nullptr;
+  size_t slot = 0;
+  bool perf_counters = false;
+  // If set, the attempt is the island `island` of an island-model search:
+  // every migration_interval stages it publishes its best state to the pool
+  // and adopts a better one from its neighbors, if there is any.
+  ElitePool *elites = nullptr;
+  size_t island = 0;
+  int32_t migration_interval = 0;
+  // Where to print a solution, if anywhere.
+  std::ostream *log = nullptr;
+  // If set, receives the encoded state of an attempt that solves it.
+  std::vector<uint32_t> *solution = nullptr;
+  // If set, every stage and step of the attempt is recorded here.
+  TraceRing *trace = nullptr;
+};
+
+struct AttemptResult {
+  bool solved;
+  uint64_t num_steps;
+};
+
+// Resumable state of an annealing attempt, taken between two temperature
+// stages. In a checkpoint it is followed by the encoded state.
+struct WorkerState {
+  uint64_t num_steps;
+  // Steps taken in the stage the attempt was stopped in.
+  uint64_t stage_steps;
+  ScheduleState schedule;
+  float min_cost;
+  Rng::State rng;
+};
+
+// Size of the checkpoint payload of an attempt whose state is num_words
+// words.
+inline size_t CheckpointPayloadSize(size_t num_words) {
+  return sizeof(WorkerState) + num_words * sizeof(uint32_t);
+}
+
+// Reports an attempt of Solve to its context: checkpoints, trace, stats,
+// phase timings and the solution. It also migrates states between islands.
+template <typename Problem>
+class SolveObserver {
+ public:
+  typedef anneal::Annealer<Problem, Rng, SolveObserver> Annealer;
+  typedef typename Problem::State State;
+
+  struct Scope : ScopedPhase {
+    Scope(SolveObserver *observer, Phase phase)
+        : ScopedPhase(&observer->profile_, phase) {}
+  };
+
+  SolveObserver(const Problem &problem, const SolverContext &context,
+                int64_t attempt)
+      : problem_(problem),
+        context_(context),
+        attempt_(attempt),
+        words_(problem.num_words()),
+        checkpoint_generation_(~0ULL),
+        published_cost_(~0U),
+        num_stages_(0),
+        num_migrations_(0) {
+    if (context_.checkpointer != nullptr) {
+      payload_.resize(context_.checkpointer->payload_size());
+    }
+    if (context_.perf_counters && !profile_.EnablePerfCounters()) {
+      static std::once_flag warned;
+      std::call_once(warned, []() {
+        std::cerr << "Hardware counters are not available." << std::endl;
+      });
+    }
+  }
+
+  const PhaseProfile &profile() const { return profile_; }
+  size_t num_migrations() const { return num_migrations_; }
+
+  bool stopped() const { return *context_.found; }
+
+  void OnStage(const Annealer &annealer) {
+    Checkpointer *checkpointer = context_.checkpointer;
+    if (checkpointer != nullptr &&
+        checkpointer->SnapshotDue(&checkpoint_generation_)) {
+      checkpointer->TryPublish(context_.slot, Checkpoint(annealer));
+    }
+    if (context_.trace != nullptr) {
+      Trace(TraceEvent::Stage, annealer.num_steps(), TraceMove::None, 0, 0,
+            false, annealer.cost(), annealer.temperature());
+    }
+  }
+
+  void OnStep(const Annealer &annealer, const typename Problem::Move &move,
+              float cost, bool accepted) {
+    if (context_.trace != nullptr) {
+      Trace(TraceEvent::Step, annealer.num_steps(), problem_.Kind(move),
+            move.first, move.second, accepted, cost, cost - annealer.cost());
+    }
+  }
+
+  void OnSolved(const Annealer &annealer) {
+    *context_.found = true;
+    if (context_.solution != nullptr) {
+      context_.solution->resize(problem_.num_words());
+      problem_.Encode(annealer.state(), context_.solution->data());
+    }
+    if (context_.log != nullptr) {
+      *context_.log << "Solved in attempt #" << attempt_ << " at step #"
+                    << annealer.num_steps() << ", temperature "
+                    << annealer.temperature() << std::endl;
+      problem_.Print(annealer.state(), *context_.log);
+    }
+  }
+
+  void OnReheat(const Annealer &annealer) {
+    if (context_.trace != nullptr) {
+      Trace(TraceEvent::Reheat, annealer.num_steps(), TraceMove::None, 0, 0,
+            false, annealer.cost(), annealer.temperature());
+    }
+  }
+
+  void OnStageEnd(Annealer *annealer, uint64_t accepted, uint64_t rejected) {
+    ElitePool *elites = context_.elites;
+    if (elites != nullptr && !*context_.found &&
+        ++num_stages_ % context_.migration_interval == 0) {
+      Migrate(elites, annealer);
+    }
+    context_.stats->UpdateAccepted(accepted);
+    context_.stats->UpdateRejected(rejected);
+    context_.stats->UpdateMinCost(annealer->min_cost());
+  }
+
+  // Stores the attempt in the checkpoint payload.
+  const char *Checkpoint(const Annealer &annealer) {
+    WorkerState state;
+    state.num_steps = annealer.num_steps();
+    state.stage_steps = annealer.stage_steps();
+    state.schedule = annealer.schedule().state();
+    state.min_cost = annealer.min_cost();
+    state.rng = annealer.rng().state();
+    memcpy(payload_.data(), &state, sizeof(state));
+    problem_.Encode(annealer.state(), words_.data());
+    memcpy(payload_.data() + sizeof(state), words_.data(),
+           words_.size() * sizeof(uint32_t));
+    return payload_.data();
+  }
+
+  // Reads back a payload stored by Checkpoint.
+  static State Restore(const Problem &problem, const char *payload,
+                       WorkerState *state) {
+    memcpy(state, payload, sizeof(*state));
+    std::vector<uint32_t> words(problem.num_words());
+    memcpy(words.data(), payload + sizeof(*state),
+           words.size() * sizeof(uint32_t));
+    return problem.Decode(words.data());
+  }
+
+ private:
+  void Trace(TraceEvent event, uint64_t step, TraceMove move, size_t first,
+             size_t second, bool accepted, float cost, float value) {
+    context_.trace->Push(TraceRecord{step, (uint32_t)attempt_, event, move,
+                                     (uint8_t)accepted, 0, (uint32_t)first,
+                                     (uint32_t)second, cost, value});
+  }
+
+  // Publishes the best state of the island, and continues from a better one
+  // of its neighbors if there is one.
+  void Migrate(ElitePool *elites, Annealer *annealer) {
+    if (annealer->best_cost() < published_cost_) {
+      problem_.Encode(annealer->best(), words_.data());
+      elites->Publish(context_.island, words_.data(), annealer->best_cost());
+      published_cost_ = annealer->best_cost();
+    }
+    uint32_t adopted_cost;
+    if (elites->Adopt(context_.island, annealer->best_cost(), words_.data(),
+                      &adopted_cost)) {
+      annealer->Adopt(problem_.Decode(words_.data()), adopted_cost);
+      num_migrations_++;
+      if (context_.trace != nullptr) {
+        Trace(TraceEvent::Migration, annealer->num_steps(), TraceMove::None,
+              0, 0, false, adopted_cost, annealer->temperature());
+      }
+    }
+  }
+
+  const Problem &problem_;
+  const SolverContext &context_;
+  const int64_t attempt_;
+  PhaseProfile profile_;
+  std::vector<char> payload_;
+  // Scratch space for encoding states.
+  std::vector<uint32_t> words_;
+  uint64_t checkpoint_generation_;
+  uint32_t published_cost_;
+  uint64_t num_stages_;
+  size_t num_migrations_;
+};
+
+// Runs attempt number `attempt`, either from a random start or, if `resume`
+// is set, from a checkpoint payload. The attempt draws from the random
+// stream (seed, attempt).
+template <typename Problem>
+AttemptResult Solve(const Problem &problem, const SolverConfig &config,
+                    const SolverContext &context, uint64_t seed,
+                    int64_t attempt, const char *resume = nullptr) {
+  typedef SolveObserver<Problem> Observer;
+  Checkpointer *checkpointer = context.checkpointer;
+  CoolingSchedule schedule = config.NewSchedule();
+
+  Rng rng(seed, attempt);
+  typename Problem::State start = problem.Start();
+  WorkerState state = {0, 0, schedule.state(), 0, {}};
+  if (resume != nullptr) {
+    start = Observer::Restore(problem, resume, &state);
+    rng = Rng(state.rng);
+    schedule.Restore(state.schedule);
+  } else {
+    problem.Randomize(&start, &rng);
+  }
+
+  Observer observer(problem, context, attempt);
+  // Islands publish their best state.
+  typename Observer::Annealer annealer(problem, start, &rng, &schedule,
+                                       &observer, context.elites != nullptr);
+  if (resume != nullptr) {
+    annealer.Resume(state.num_steps, state.stage_steps, state.min_cost);
+  }
+  bool solved = annealer.Run();
+
+  Stats *stats = context.stats;
+  stats->UpdateMinCost(annealer.min_cost());
+  stats->UpdateReheats(annealer.num_reheats());
+  stats->UpdateMigrations(observer.num_migrations());
+  stats->UpdateProfile(observer.profile());
+
+  if (checkpointer != nullptr) {
+    if (!solved && !schedule.done()) {
+      // Stopped before the schedule ran out; resume with the rest of the
+      // stage in progress.
+      checkpointer->Publish(context.slot, observer.Checkpoint(annealer));
+    } else {
+      checkpointer->Clear(context.slot);
+    }
+  }
+  return AttemptResult{solved, annealer.num_steps()};
+}
+
+// Runs attempts 0, 1, ... of `seed` one after another on the calling thread
+// until one succeeds or max_attempts have failed, for the TTS harness.
+template <typename Problem>
+RunResult RunToSolution(const Problem &problem, const SolverConfig &config,
+                        uint64_t seed, int64_t max_attempts) {
+  Stats stats;
+  volatile bool found = false;
+  SolverContext context;
+  context.stats = &stats;
+  context.found = &found;
+
+  RunResult result = {false, 0, 0, 0};
+  auto begin = std::chrono::steady_clock::now();
+  while (!result.solved && result.attempts < max_attempts) {
+    AttemptResult attempt =
+        Solve(problem, config, context, seed, result.attempts);
+    result.solved = attempt.solved;
+    result.evaluations += attempt.num_steps;
+    result.attempts++;
+  }
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - begin)
+                       .count();
+  return result;
+}
+
+}  // namespace anneal
+
+#endif  // ANNEAL_SOLVER_H_
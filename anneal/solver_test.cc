@@ -0,0 +1,219 @@
+#include "solver.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <stdlib.h>
+
+#include "checkpoint.h"
+#include "elite_pool.h"
+#include "stats.h"
+
+using anneal::AttemptResult;
+using anneal::CheckpointPayloadSize;
+using anneal::CheckpointReader;
+using anneal::Checkpointer;
+using anneal::ElitePool;
+using anneal::SolverConfig;
+using anneal::SolverContext;
+using anneal::Stats;
+using anneal::Topology;
+using anneal::WorkerState;
+
+static const size_t kSize = 16;
+static const uint64_t kSeed = 1;
+static const int64_t kAttempt = 3;
+static const uint64_t kFingerprint = 42;
+
+// Sorts a permutation by swapping pairs of elements. Its cost never reaches
+// zero, so attempts only end with their schedule or when stopped.
+struct ShuffleProblem {
+  typedef std::vector<uint32_t> State;
+  struct Move {
+    size_t first;
+    size_t second;
+  };
+
+  template <typename Random>
+  Move Propose(State *state, Random *rng) const {
+    // Stops the attempt after this step, as another attempt solving the run
+    // would.
+    if (++num_proposals == stop_after) {
+      *found = true;
+    }
+    Move move = {rng->Below(kSize), rng->Below(kSize)};
+    std::swap((*state)[move.first], (*state)[move.second]);
+    return move;
+  }
+
+  float Cost(const State &state) const {
+    float cost = 1;
+    for (size_t i = 0; i < kSize; i++) {
+      cost += abs((int)state[i] - (int)i);
+    }
+    return cost;
+  }
+
+  void Undo(State *state, const Move &move) const {
+    std::swap((*state)[move.first], (*state)[move.second]);
+  }
+
+  // Sorted, the best state, or reversed, the worst.
+  State Start() const {
+    State state(kSize);
+    for (size_t i = 0; i < kSize; i++) {
+      state[i] = reversed ? kSize - 1 - i : i;
+    }
+    return state;
+  }
+
+  template <typename Random>
+  void Randomize(State *state, Random *rng) const {
+    for (size_t i = kSize - 1; shuffle && i > 0; i--) {
+      std::swap((*state)[i], (*state)[rng->Below(i + 1)]);
+    }
+  }
+
+  size_t num_words() const { return kSize; }
+  void Encode(const State &state, uint32_t *words) const {
+    std::copy(state.begin(), state.end(), words);
+  }
+  State Decode(const uint32_t *words) const {
+    return State(words, words + kSize);
+  }
+  anneal::TraceMove Kind(const Move &move) const {
+    return anneal::TraceMove::Swap;
+  }
+  void Print(const State &state, std::ostream &os) const {}
+  std::string Describe() const { return "shuffle"; }
+
+  volatile bool *found = nullptr;
+  // Never stops if 0.
+  uint64_t stop_after = 0;
+  mutable uint64_t num_proposals = 0;
+  bool shuffle = true;
+  bool reversed = false;
+};
+
+typedef anneal::SolveObserver<ShuffleProblem> Observer;
+
+static std::string TempPath() {
+  const char *dir = getenv("TEST_TMPDIR");
+  return std::string(dir != nullptr ? dir : "/tmp") + "/solver_test.ckpt";
+}
+
+// Runs the attempt, from `resume` if not empty, for `steps` steps or until
+// its schedule ends if 0, and returns the payload it leaves in its
+// checkpoint slot, if any.
+static std::vector<char> RunAttempt(const std::vector<char> &resume,
+                                    uint64_t steps, uint64_t *num_steps) {
+  volatile bool found = false;
+  ShuffleProblem problem;
+  problem.found = &found;
+  problem.stop_after = steps;
+  size_t payload_size = CheckpointPayloadSize(kSize);
+  Checkpointer checkpointer(TempPath(), kFingerprint, 1, payload_size);
+  checkpointer.Begin(0, kAttempt);
+  Stats stats;
+  SolverContext context;
+  context.stats = &stats;
+  context.found = &found;
+  context.checkpointer = &checkpointer;
+  AttemptResult result =
+      anneal::Solve(problem, SolverConfig(), context, kSeed, kAttempt,
+                    resume.empty() ? nullptr : resume.data());
+  EXPECT_FALSE(result.solved);
+  *num_steps = result.num_steps;
+
+  EXPECT_TRUE(checkpointer.Write());
+  std::unique_ptr<CheckpointReader> reader =
+      CheckpointReader::Open(TempPath(), kFingerprint, payload_size);
+  if (reader == nullptr || reader->payload(0) == nullptr) {
+    return std::vector<char>();
+  }
+  const char *payload = static_cast<const char *>(reader->payload(0));
+  return std::vector<char>(payload, payload + payload_size);
+}
+
+static void ExpectSameAttempt(const std::vector<char> &expected,
+                              const std::vector<char> &actual) {
+  ASSERT_FALSE(expected.empty());
+  ASSERT_FALSE(actual.empty());
+  WorkerState a, b;
+  ShuffleProblem problem;
+  EXPECT_EQ(Observer::Restore(problem, expected.data(), &a),
+            Observer::Restore(problem, actual.data(), &b));
+  EXPECT_EQ(a.num_steps, b.num_steps);
+  EXPECT_EQ(a.stage_steps, b.stage_steps);
+  EXPECT_EQ(a.schedule.temperature, b.schedule.temperature);
+  EXPECT_EQ(a.schedule.best_temperature, b.schedule.best_temperature);
+  EXPECT_EQ(a.schedule.stage_length, b.schedule.stage_length);
+  EXPECT_EQ(a.schedule.num_reheats, b.schedule.num_reheats);
+  EXPECT_EQ(a.schedule.stagnant_stages, b.schedule.stagnant_stages);
+  EXPECT_EQ(a.min_cost, b.min_cost);
+  for (size_t i = 0; i < 4; i++) {
+    EXPECT_EQ(a.rng.s[i], b.rng.s[i]);
+  }
+}
+
+TEST(SolverTest, ResumedAttemptTakesTheSameSteps) {
+  // Stages are 24 steps long, so both stops are in the middle of a stage.
+  uint64_t num_steps;
+  std::vector<char> stopped =
+      RunAttempt(std::vector<char>(), 100, &num_steps);
+  EXPECT_EQ(100U, num_steps);
+  ASSERT_FALSE(stopped.empty());
+  WorkerState state;
+  Observer::Restore(ShuffleProblem(), stopped.data(), &state);
+  EXPECT_EQ(100U % 24, state.stage_steps);
+
+  std::vector<char> resumed = RunAttempt(stopped, 150, &num_steps);
+  EXPECT_EQ(250U, num_steps);
+  std::vector<char> uninterrupted =
+      RunAttempt(std::vector<char>(), 250, &num_steps);
+  EXPECT_EQ(250U, num_steps);
+  ExpectSameAttempt(uninterrupted, resumed);
+
+  // Attempts that run out of schedule leave no payload behind.
+  uint64_t resumed_steps;
+  EXPECT_TRUE(RunAttempt(stopped, 0, &resumed_steps).empty());
+  EXPECT_TRUE(RunAttempt(std::vector<char>(), 0, &num_steps).empty());
+  EXPECT_EQ(num_steps, resumed_steps);
+}
+
+TEST(SolverTest, IslandsAdoptBetterStatesOfEachOther) {
+  // Cold and short enough that a reversed permutation cannot be sorted by
+  // the annealing itself.
+  SolverConfig config;
+  config.t_max = 1e-3;
+  config.t_min = 1e-4;
+  config.annealing_steps = 3;
+  config.max_tries = 2;
+  for (size_t good = 0; good < 2; good++) {
+    ElitePool elites(2, kSize, Topology::Ring);
+    // The good island runs first and publishes the sorted permutation.
+    for (size_t island : {good, 1 - good}) {
+      volatile bool found = false;
+      ShuffleProblem problem;
+      problem.shuffle = false;
+      problem.reversed = island != good;
+      Stats stats;
+      SolverContext context;
+      context.stats = &stats;
+      context.found = &found;
+      context.elites = &elites;
+      context.island = island;
+      context.migration_interval = 1;
+      anneal::Solve(problem, config, context, kSeed, island);
+      EXPECT_EQ(island == good ? 0U : 1U, stats.GetMigrations());
+    }
+
+    // The other island adopted it, and published it in turn.
+    std::vector<uint32_t> words(kSize);
+    uint32_t cost;
+    ASSERT_TRUE(elites.Adopt(good, ~0U, words.data(), &cost));
+    EXPECT_EQ(1U, cost);
+    EXPECT_EQ(ShuffleProblem().Start(), words);
+  }
+}
@@ -0,0 +1,115 @@
+#ifndef ANNEAL_STATS_H_
+#define ANNEAL_STATS_H_
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <ostream>
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "profile.h"
+
+namespace anneal {
+
+// Counters of the attempts of a run, updated concurrently by their threads.
+// Stats are aligned to, and padded to a multiple of, a cache line, so that
+// the counters of one socket never share a line with anything else.
+class alignas(64) Stats {
+ public:
+  // Before C++17 new does not honor alignments beyond max_align_t.
+  static void *operator new(size_t size) {
+    void *memory;
+    if (posix_memalign(&memory, alignof(Stats), size) != 0) {
+      throw std::bad_alloc();
+    }
+    return memory;
+  }
+  static void operator delete(void *memory) { free(memory); }
+
+  Stats()
+      : start_(clock()),
+        num_accepted_(0),
+        num_rejected_(0),
+        num_reheats_(0),
+        num_migrations_(0),
+        min_cost_(std::numeric_limits<short>::max()) {}
+
+  void UpdateAccepted(size_t delta_accepted) {
+    std::atomic_fetch_add(&num_accepted_, delta_accepted);
+  }
+
+  void UpdateRejected(size_t delta_rejected) {
+    std::atomic_fetch_add(&num_rejected_, delta_rejected);
+  }
+
+  void UpdateReheats(size_t delta_reheats) {
+    std::atomic_fetch_add(&num_reheats_, delta_reheats);
+  }
+
+  void UpdateMigrations(size_t delta_migrations) {
+    std::atomic_fetch_add(&num_migrations_, delta_migrations);
+  }
+
+  void UpdateMinCost(size_t min_cost) {
+    if (min_cost < min_cost_) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      min_cost_ = std::min(min_cost, min_cost_);
+    }
+  }
+
+  void UpdateProfile(const PhaseProfile &profile) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    profile_.Merge(profile);
+  }
+
+  // Adds the counters of `other`, e.g. those of one socket to the total of
+  // all sockets.
+  void Add(const Stats &other) {
+    num_accepted_ += other.num_accepted_;
+    num_rejected_ += other.num_rejected_;
+    num_reheats_ += other.num_reheats_;
+    num_migrations_ += other.num_migrations_;
+    std::lock_guard<std::mutex> other_lock(other.mutex_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    start_ = std::min(start_, other.start_);
+    min_cost_ = std::min(min_cost_, other.min_cost_);
+    profile_.Merge(other.profile_);
+  }
+
+  size_t GetAccepted() const { return num_accepted_; }
+  size_t GetRejected() const { return num_rejected_; }
+  size_t GetReheats() const { return num_reheats_; }
+  size_t GetMigrations() const { return num_migrations_; }
+  float GetElapsedSeconds() const {
+    return (float)(clock() - start_) / CLOCKS_PER_SEC;
+  }
+
+  std::ostream &Dump(std::ostream &os) {
+    os << "Elapsed time:     " << GetElapsedSeconds() << " (s)" << std::endl
+       << "Rejected configs: " << GetRejected() << std::endl
+       << "Accepted configs: " << GetAccepted() << std::endl
+       << "Reheats:          " << GetReheats() << std::endl
+       << "Migrations:       " << GetMigrations() << std::endl
+       << "Min cost:         " << min_cost_ << std::endl;
+    std::lock_guard<std::mutex> lock(mutex_);
+    return profile_.Dump(os);
+  }
+
+ private:
+  clock_t start_;
+  mutable std::mutex mutex_;
+  std::atomic<size_t> num_accepted_;
+  std::atomic<size_t> num_rejected_;
+  std::atomic<size_t> num_reheats_;
+  std::atomic<size_t> num_migrations_;
+  size_t min_cost_;
+  PhaseProfile profile_;
+};
+
+}  // namespace anneal
+
+#endif  // ANNEAL_STATS_H_
@@ -0,0 +1,152 @@
+#include "topology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <utility>
+
+#include <ctype.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+namespace anneal {
+
+static bool ReadFile(const std::string &path, std::string *contents) {
+  std::ifstream in(path);
+  if (!in) {
+    return false;
+  }
+  std::getline(in, *contents);
+  return true;
+}
+
+static int ReadInt(const std::string &path, int fallback) {
+  std::string contents;
+  return ReadFile(path, &contents) && !contents.empty() ? atoi(contents.c_str())
+                                                        : fallback;
+}
+
+// The cpuN directory has a nodeM link for the NUMA node of the CPU.
+static int ReadNode(const std::string &cpu_dir) {
+  DIR *dir = opendir(cpu_dir.c_str());
+  if (dir == nullptr) {
+    return -1;
+  }
+  int node = -1;
+  while (struct dirent *entry = readdir(dir)) {
+    if (strncmp(entry->d_name, "node", 4) == 0 && isdigit(entry->d_name[4])) {
+      node = atoi(entry->d_name + 4);
+      break;
+    }
+  }
+  closedir(dir);
+  return node;
+}
+
+/* static */
+bool CpuTopology::ParseCpuList(const std::string &list,
+                               std::vector<int> *ids) {
+  std::istringstream ranges(list);
+  std::string range;
+  while (std::getline(ranges, range, ',')) {
+    int first, last;
+    char dash;
+    std::istringstream fields(range);
+    if (!(fields >> first)) {
+      return false;
+    }
+    last = first;
+    if (fields >> dash && !(dash == '-' && fields >> last)) {
+      return false;
+    }
+    for (int id = first; id <= last; id++) {
+      ids->push_back(id);
+    }
+  }
+  return !ids->empty();
+}
+
+/* static */
+CpuTopology CpuTopology::Read(const std::string &sysfs_root) {
+  std::string online;
+  std::vector<int> ids;
+  if (!ReadFile(sysfs_root + "/cpu/online", &online) ||
+      !ParseCpuList(online, &ids)) {
+    ids.clear();
+    for (int id = 0; id < CPU_SETSIZE; id++) {
+      ids.push_back(id);
+    }
+  }
+
+  cpu_set_t allowed;
+  bool have_mask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+  std::vector<Cpu> cpus;
+  for (int id : ids) {
+    if (id >= CPU_SETSIZE || (have_mask && !CPU_ISSET(id, &allowed))) {
+      continue;
+    }
+    std::string dir = sysfs_root + "/cpu/cpu" + std::to_string(id);
+    cpus.push_back(Cpu{id,
+                       ReadInt(dir + "/topology/physical_package_id", 0),
+                       ReadInt(dir + "/topology/core_id", id),
+                       ReadNode(dir)});
+  }
+  if (cpus.empty()) {
+    cpus.push_back(Cpu{0, 0, 0, -1});
+  }
+  return CpuTopology(std::move(cpus));
+}
+
+CpuTopology::CpuTopology(std::vector<Cpu> cpus) : cpus_(std::move(cpus)) {
+  // Renumber sockets densely, and group the CPUs of each physical core.
+  std::map<int, int> sockets;
+  for (const auto &cpu : cpus_) {
+    sockets.emplace(cpu.socket, 0);
+  }
+  int next = 0;
+  for (auto &socket : sockets) {
+    socket.second = next++;
+  }
+  num_sockets_ = sockets.size();
+
+  std::vector<std::map<int, std::vector<size_t>>> cores(num_sockets_);
+  for (size_t i = 0; i < cpus_.size(); i++) {
+    cpus_[i].socket = sockets[cpus_[i].socket];
+    cores[cpus_[i].socket][cpus_[i].core].push_back(i);
+  }
+
+  // Round `sibling` takes the sibling-th hyperthread of every core, and
+  // within a round the sockets take turns.
+  std::vector<std::vector<const std::vector<size_t> *>> by_socket(
+      num_sockets_);
+  size_t max_cores = 0;
+  for (size_t socket = 0; socket < num_sockets_; socket++) {
+    for (const auto &core : cores[socket]) {
+      by_socket[socket].push_back(&core.second);
+    }
+    max_cores = std::max(max_cores, by_socket[socket].size());
+  }
+  for (size_t sibling = 0; order_.size() < cpus_.size(); sibling++) {
+    for (size_t core = 0; core < max_cores; core++) {
+      for (size_t socket = 0; socket < num_sockets_; socket++) {
+        if (core < by_socket[socket].size() &&
+            sibling < by_socket[socket][core]->size()) {
+          order_.push_back((*by_socket[socket][core])[sibling]);
+        }
+      }
+    }
+  }
+}
+
+/* static */
+bool CpuTopology::Pin(const Cpu &cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu.id, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+}  // namespace anneal
@@ -0,0 +1,59 @@
+#ifndef ANNEAL_TOPOLOGY_H_
+#define ANNEAL_TOPOLOGY_H_
+
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+
+namespace anneal {
+
+// The logical CPUs this process may run on, grouped into physical cores and
+// sockets as the kernel reports them in sysfs, and the placement of solver
+// threads on them.
+class CpuTopology {
+ public:
+  struct Cpu {
+    int id;
+    // Dense index of the socket, in [0, num_sockets).
+    int socket;
+    int core;
+    // NUMA node, or -1 if unknown.
+    int node;
+  };
+
+  // Reads the topology under sysfs_root, restricted to the CPUs in the
+  // affinity mask of the process. Falls back to treating every CPU as a
+  // core of a single socket if sysfs cannot be read.
+  static CpuTopology Read(
+      const std::string &sysfs_root = "/sys/devices/system");
+
+  // Parses a kernel CPU list such as "0-3,8,10-11".
+  static bool ParseCpuList(const std::string &list, std::vector<int> *ids);
+
+  explicit CpuTopology(std::vector<Cpu> cpus);
+
+  size_t num_cpus() const { return cpus_.size(); }
+  size_t num_sockets() const { return num_sockets_; }
+
+  // CPU of the `worker`th solver thread. Workers get a physical core each
+  // before any core gets a second hyperthread, and consecutive workers
+  // alternate between sockets so that both memory controllers are used from
+  // the first threads on. Past the number of CPUs placement wraps around.
+  const Cpu &ForWorker(size_t worker) const {
+    return cpus_[order_[worker % order_.size()]];
+  }
+
+  // Pins the calling thread to `cpu`. Returns false if that is not
+  // permitted.
+  static bool Pin(const Cpu &cpu);
+
+ private:
+  std::vector<Cpu> cpus_;
+  std::vector<size_t> order_;
+  size_t num_sockets_;
+};
+
+}  // namespace anneal
+
+#endif  // ANNEAL_TOPOLOGY_H_
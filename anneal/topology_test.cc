@@ -0,0 +1,63 @@
+#include "topology.h"
+#include "gtest/gtest.h"
+
+using anneal::CpuTopology;
+
+TEST(TopologyTest, ParsesCpuLists) {
+  std::vector<int> ids;
+  ASSERT_TRUE(CpuTopology::ParseCpuList("0-3,8,10-11", &ids));
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 8, 10, 11}), ids);
+
+  ids.clear();
+  EXPECT_FALSE(CpuTopology::ParseCpuList("", &ids));
+  EXPECT_FALSE(CpuTopology::ParseCpuList("0-", &ids));
+}
+
+// Two sockets of two cores with two hyperthreads each, numbered like Linux
+// does: the first hyperthread of every core before the second ones.
+static CpuTopology TwoSockets() {
+  return CpuTopology({{0, 0, 0, 0},
+                      {1, 0, 1, 0},
+                      {2, 1, 0, 1},
+                      {3, 1, 1, 1},
+                      {4, 0, 0, 0},
+                      {5, 0, 1, 0},
+                      {6, 1, 0, 1},
+                      {7, 1, 1, 1}});
+}
+
+TEST(TopologyTest, SpreadsWorkersOverCoresAndSockets) {
+  CpuTopology topology = TwoSockets();
+  EXPECT_EQ(8U, topology.num_cpus());
+  EXPECT_EQ(2U, topology.num_sockets());
+
+  // Physical cores first, alternating sockets, then the siblings.
+  std::vector<int> ids;
+  for (size_t worker = 0; worker < 8; worker++) {
+    ids.push_back(topology.ForWorker(worker).id);
+  }
+  EXPECT_EQ(std::vector<int>({0, 2, 1, 3, 4, 6, 5, 7}), ids);
+  EXPECT_EQ(1, topology.ForWorker(1).socket);
+  // Past the number of CPUs, placement wraps around.
+  EXPECT_EQ(0, topology.ForWorker(8).id);
+}
+
+TEST(TopologyTest, NumbersSocketsDensely) {
+  CpuTopology topology({{0, 3, 0, -1}, {1, 7, 0, -1}});
+  EXPECT_EQ(2U, topology.num_sockets());
+  EXPECT_EQ(0, topology.ForWorker(0).socket);
+  EXPECT_EQ(1, topology.ForWorker(1).socket);
+}
+
+TEST(TopologyTest, FallsBackToOneSocketWithoutSysfs) {
+  CpuTopology topology = CpuTopology::Read("/nonexistent");
+  EXPECT_LE(1U, topology.num_cpus());
+  EXPECT_EQ(1U, topology.num_sockets());
+}
+
+TEST(TopologyTest, ReadsThisHost) {
+  CpuTopology topology = CpuTopology::Read();
+  EXPECT_LE(1U, topology.num_cpus());
+  EXPECT_LE(1U, topology.num_sockets());
+  EXPECT_TRUE(CpuTopology::Pin(topology.ForWorker(0)));
+}
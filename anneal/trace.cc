@@ -0,0 +1,213 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace anneal {
+
+static const char kMagic[4] = {'A', 'N', 'T', 'R'};
+static const uint32_t kVersion = 1;
+
+// Records per ring: 1 MiB per solver thread.
+static const size_t kRingCapacity = 1 << 15;
+
+static uint64_t RoundUpToPowerOfTwo(size_t n) {
+  uint64_t power = 1;
+  while (power < n) {
+    power *= 2;
+  }
+  return power;
+}
+
+TraceRing::TraceRing(size_t capacity)
+    : mask_(RoundUpToPowerOfTwo(capacity) - 1),
+      records_(new TraceRecord[mask_ + 1]),
+      tail_(0),
+      cached_head_(0),
+      head_(0) {}
+
+size_t TraceRing::Drain(TraceRecord *out, size_t max_records) {
+  uint64_t head = head_.load(std::memory_order_relaxed);
+  uint64_t tail = tail_.load(std::memory_order_acquire);
+  size_t count = std::min<uint64_t>(tail - head, max_records);
+  for (size_t i = 0; i < count; i++) {
+    out[i] = records_[(head + i) & mask_];
+  }
+  head_.store(head + count, std::memory_order_release);
+  return count;
+}
+
+/* static */
+std::unique_ptr<TraceWriter> TraceWriter::Open(const std::string &path,
+                                               size_t num_rings) {
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    std::cerr << "Cannot create " << path << ": " << strerror(errno)
+              << std::endl;
+    return nullptr;
+  }
+  std::unique_ptr<TraceWriter> writer(new TraceWriter(path, fd, num_rings));
+  if (!writer->Reserve(kRingCapacity)) {
+    return nullptr;
+  }
+  writer->writer_ = std::thread(&TraceWriter::Run, writer.get());
+  return writer;
+}
+
+TraceWriter::TraceWriter(const std::string &path, int fd, size_t num_rings)
+    : path_(path),
+      fd_(fd),
+      data_(nullptr),
+      mapped_size_(0),
+      num_records_(0),
+      failed_(false),
+      stopping_(false) {
+  for (size_t i = 0; i < num_rings; i++) {
+    rings_.emplace_back(new TraceRing(kRingCapacity));
+  }
+}
+
+TraceWriter::~TraceWriter() {
+  Close();
+}
+
+bool TraceWriter::Reserve(size_t count) {
+  size_t needed =
+      sizeof(TraceHeader) + (num_records_ + count) * sizeof(TraceRecord);
+  if (needed <= mapped_size_) {
+    return true;
+  }
+  size_t size = std::max(needed, 2 * mapped_size_);
+  void *data = MAP_FAILED;
+  if (ftruncate(fd_, size) == 0) {
+    data = data_ == nullptr
+               ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0)
+               : mremap(data_, mapped_size_, size, MREMAP_MAYMOVE);
+  }
+  if (data == MAP_FAILED) {
+    std::cerr << "Cannot grow " << path_ << ": " << strerror(errno)
+              << std::endl;
+    return false;
+  }
+  data_ = static_cast<char *>(data);
+  mapped_size_ = size;
+  return true;
+}
+
+size_t TraceWriter::DrainAll() {
+  size_t drained = 0;
+  for (auto &ring : rings_) {
+    if (!failed_ && !Reserve(kRingCapacity)) {
+      failed_ = true;
+    }
+    if (failed_) {
+      // Keep the solvers going; the trace is lost anyway.
+      static TraceRecord discarded[kRingCapacity];
+      drained += ring->Drain(discarded, kRingCapacity);
+      continue;
+    }
+    TraceRecord *out = reinterpret_cast<TraceRecord *>(
+                           data_ + sizeof(TraceHeader)) +
+                       num_records_;
+    size_t count = ring->Drain(out, kRingCapacity);
+    num_records_ += count;
+    drained += count;
+  }
+  return drained;
+}
+
+void TraceWriter::Run() {
+  while (!stopping_) {
+    if (DrainAll() == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+}
+
+bool TraceWriter::Close() {
+  if (fd_ < 0) {
+    return !failed_;
+  }
+  stopping_ = true;
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+  // The solver threads are done; pick up what they pushed last.
+  while (DrainAll() > 0) {
+  }
+
+  if (data_ != nullptr) {
+    TraceHeader header = {};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.record_size = sizeof(TraceRecord);
+    header.num_records = failed_ ? 0 : num_records_;
+    memcpy(data_, &header, sizeof(header));
+    munmap(data_, mapped_size_);
+    data_ = nullptr;
+  }
+  if (ftruncate(fd_, sizeof(TraceHeader) +
+                         num_records_ * sizeof(TraceRecord)) != 0 ||
+      close(fd_) != 0) {
+    std::cerr << "Cannot write " << path_ << ": " << strerror(errno)
+              << std::endl;
+    failed_ = true;
+  }
+  fd_ = -1;
+  return !failed_;
+}
+
+/* static */
+std::unique_ptr<TraceReader> TraceReader::Open(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "Cannot open " << path << ": " << strerror(errno)
+              << std::endl;
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TraceHeader)) {
+    std::cerr << path << " is not a trace" << std::endl;
+    close(fd);
+    return nullptr;
+  }
+  void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    std::cerr << "Cannot map " << path << ": " << strerror(errno) << std::endl;
+    return nullptr;
+  }
+
+  std::unique_ptr<TraceReader> reader(new TraceReader(data, st.st_size));
+  const TraceHeader &header = *reader->header_;
+  if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion ||
+      header.record_size != sizeof(TraceRecord)) {
+    std::cerr << path << " is not a valid trace" << std::endl;
+    return nullptr;
+  }
+  if (sizeof(TraceHeader) + header.num_records * sizeof(TraceRecord) >
+      (size_t)st.st_size) {
+    std::cerr << path << " is truncated or corrupt" << std::endl;
+    return nullptr;
+  }
+  return reader;
+}
+
+TraceReader::TraceReader(const void *data, size_t size)
+    : data_(data),
+      size_(size),
+      header_(static_cast<const TraceHeader *>(data)),
+      records_(reinterpret_cast<const TraceRecord *>(header_ + 1)) {}
+
+TraceReader::~TraceReader() { munmap(const_cast<void *>(data_), size_); }
+
+}  // namespace anneal
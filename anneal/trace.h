@@ -0,0 +1,167 @@
+#ifndef ANNEAL_TRACE_H_
+#define ANNEAL_TRACE_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace anneal {
+
+enum class TraceEvent : uint8_t {
+  // A temperature stage begins. cost is the current cost, value the
+  // temperature.
+  Stage,
+  // A proposal was evaluated. cost is the proposed cost, value its delta to
+  // the current cost.
+  Step,
+  // The attempt went back to its best board, of cost `cost`.
+  Reheat,
+  // The island adopted a board of cost `cost` from a neighbor.
+  Migration,
+};
+
+enum class TraceMove : uint8_t {
+  None,
+  // Swapped elements first and second, e.g. the columns of two rows.
+  Swap,
+  // Moved element `first` to position `second`, e.g. a piece to the square
+  // numbered row by row.
+  Move,
+  // Permuted elements first to second.
+  Permute,
+};
+
+// Fixed-size record of a trace. Records of one attempt are in order; the
+// records of concurrent attempts are interleaved.
+struct TraceRecord {
+  uint64_t step;
+  uint32_t attempt;
+  TraceEvent event;
+  TraceMove move;
+  uint8_t accepted;
+  uint8_t reserved;
+  uint32_t first;
+  uint32_t second;
+  float cost;
+  float value;
+};
+
+static_assert(sizeof(TraceRecord) == 32, "TraceRecord must stay compact");
+
+// On-disk layout of a trace: a TraceHeader followed by num_records records.
+struct TraceHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t reserved;
+  uint64_t num_records;
+  uint64_t reserved2;
+};
+
+// Lock-free ring buffer between one solver thread and the trace writer.
+class TraceRing {
+ public:
+  // Capacity is rounded up to a power of two.
+  explicit TraceRing(size_t capacity);
+  TraceRing(const TraceRing &) = delete;
+  TraceRing &operator=(const TraceRing &) = delete;
+
+  // Appends a record. Waits for the writer if the ring is full, so that
+  // traces are complete rather than sampled.
+  void Push(const TraceRecord &record) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    while (tail - cached_head_ > mask_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ > mask_) {
+        std::this_thread::yield();
+      }
+    }
+    records_[tail & mask_] = record;
+    tail_.store(tail + 1, std::memory_order_release);
+  }
+
+  // Moves up to max_records of the oldest records to out. Returns how many.
+  // Only called by the writer.
+  size_t Drain(TraceRecord *out, size_t max_records);
+
+ private:
+  const uint64_t mask_;
+  std::unique_ptr<TraceRecord[]> records_;
+  // The producer's and the consumer's positions are kept on separate cache
+  // lines.
+  char padding0_[64];
+  std::atomic<uint64_t> tail_;
+  uint64_t cached_head_;
+  char padding1_[64];
+  std::atomic<uint64_t> head_;
+  char padding2_[64];
+};
+
+// Drains a ring per solver thread into a memory-mapped file from a
+// background thread.
+class TraceWriter {
+ public:
+  // Returns nullptr (and reports why on stderr) if the file cannot be
+  // created.
+  static std::unique_ptr<TraceWriter> Open(const std::string &path,
+                                           size_t num_rings);
+  ~TraceWriter();
+
+  // Ring of solver thread `slot`. A slot must only be used by one thread at
+  // a time.
+  TraceRing *ring(size_t slot) { return rings_[slot].get(); }
+
+  // Stops the writer after draining every ring, and finalizes the file.
+  // Returns false on I/O errors.
+  bool Close();
+
+  uint64_t num_records() const { return num_records_; }
+
+ private:
+  TraceWriter(const std::string &path, int fd, size_t num_rings);
+
+  void Run();
+  // Drains all rings once. Returns the number of records written.
+  size_t DrainAll();
+  // Makes room for at least `count` more records in the mapping.
+  bool Reserve(size_t count);
+
+  const std::string path_;
+  int fd_;
+  std::vector<std::unique_ptr<TraceRing>> rings_;
+  char *data_;
+  size_t mapped_size_;
+  uint64_t num_records_;
+  bool failed_;
+  std::atomic<bool> stopping_;
+  std::thread writer_;
+};
+
+// Read-only, memory-mapped view of a trace written by TraceWriter.
+class TraceReader {
+ public:
+  // Returns nullptr (and reports why on stderr) if the file cannot be mapped
+  // or is not a complete trace.
+  static std::unique_ptr<TraceReader> Open(const std::string &path);
+  ~TraceReader();
+
+  uint64_t num_records() const { return header_->num_records; }
+  const TraceRecord &record(uint64_t index) const { return records_[index]; }
+
+ private:
+  TraceReader(const void *data, size_t size);
+
+  const void *data_;
+  size_t size_;
+  const TraceHeader *header_;
+  const TraceRecord *records_;
+};
+
+}  // namespace anneal
+
+#endif  // ANNEAL_TRACE_H_
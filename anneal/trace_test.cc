@@ -0,0 +1,90 @@
+#include "trace.h"
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+using anneal::TraceEvent;
+using anneal::TraceReader;
+using anneal::TraceRecord;
+using anneal::TraceRing;
+using anneal::TraceWriter;
+
+static std::string TracePath() {
+  const char *dir = getenv("TEST_TMPDIR");
+  return std::string(dir != nullptr ? dir : "/tmp") + "/trace_test.trace";
+}
+
+static TraceRecord Step(uint32_t attempt, uint64_t step) {
+  TraceRecord record = {};
+  record.event = TraceEvent::Step;
+  record.attempt = attempt;
+  record.step = step;
+  record.cost = step % 7;
+  return record;
+}
+
+TEST(TraceTest, RingKeepsOrderAcrossWrapAround) {
+  TraceRing ring(3);
+  TraceRecord out[4];
+  uint64_t next = 0;
+  for (uint64_t step = 0; step < 10; step++) {
+    ring.Push(Step(0, step));
+    if (step % 3 == 2) {
+      size_t count = ring.Drain(out, 4);
+      EXPECT_EQ(3U, count);
+      for (size_t i = 0; i < count; i++) {
+        EXPECT_EQ(next++, out[i].step);
+      }
+    }
+  }
+  ASSERT_EQ(1U, ring.Drain(out, 4));
+  EXPECT_EQ(9U, out[0].step);
+  EXPECT_EQ(0U, ring.Drain(out, 4));
+}
+
+TEST(TraceTest, WriterRecordsEveryThread) {
+  // More records than fit in a ring, so producers have to wait for the
+  // writer and the file has to grow.
+  const uint64_t kNumSteps = 100000;
+  auto writer = TraceWriter::Open(TracePath(), 2);
+  ASSERT_TRUE(writer != nullptr);
+  std::vector<std::thread> threads;
+  for (uint32_t slot = 0; slot < 2; slot++) {
+    threads.emplace_back([&writer, slot, kNumSteps]() {
+      for (uint64_t step = 0; step < kNumSteps; step++) {
+        writer->ring(slot)->Push(Step(slot, step));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_TRUE(writer->Close());
+  EXPECT_EQ(2 * kNumSteps, writer->num_records());
+
+  auto reader = TraceReader::Open(TracePath());
+  ASSERT_TRUE(reader != nullptr);
+  ASSERT_EQ(2 * kNumSteps, reader->num_records());
+  uint64_t next[2] = {0, 0};
+  for (uint64_t i = 0; i < reader->num_records(); i++) {
+    const TraceRecord &record = reader->record(i);
+    ASSERT_LT(record.attempt, 2U);
+    ASSERT_EQ(next[record.attempt]++, record.step);
+    EXPECT_EQ(record.step % 7, record.cost);
+  }
+  remove(TracePath().c_str());
+}
+
+TEST(TraceTest, ReaderRejectsOtherFiles) {
+  {
+    std::ofstream out(TracePath());
+    out << "attempt,step,event,move,first,second,accepted,cost,delta\n";
+  }
+  EXPECT_TRUE(TraceReader::Open(TracePath()) == nullptr);
+  remove(TracePath().c_str());
+  EXPECT_TRUE(TraceReader::Open(TracePath()) == nullptr);
+}
@@ -0,0 +1,72 @@
+// Converts a trace written by `nq --trace_file` or `atax --trace_file` to CSV
+// on stdout, one line per record. The temperature column carries the
+// temperature of the stage each step belongs to.
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+#include <gflags/gflags.h>
+
+#include "trace.h"
+
+DEFINE_string(trace_file, "", "Trace to convert.");
+
+static const char *EventName(anneal::TraceEvent event) {
+  switch (event) {
+    case anneal::TraceEvent::Stage:
+      return "stage";
+    case anneal::TraceEvent::Step:
+      return "step";
+    case anneal::TraceEvent::Reheat:
+      return "reheat";
+    case anneal::TraceEvent::Migration:
+      return "migration";
+  }
+  return "unknown";
+}
+
+static const char *MoveName(anneal::TraceMove move) {
+  switch (move) {
+    case anneal::TraceMove::None:
+      return "";
+    case anneal::TraceMove::Swap:
+      return "swap";
+    case anneal::TraceMove::Move:
+      return "move";
+    case anneal::TraceMove::Permute:
+      return "permute";
+  }
+  return "unknown";
+}
+
+int main(int argc, char **argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::unique_ptr<anneal::TraceReader> reader =
+      anneal::TraceReader::Open(FLAGS_trace_file);
+  if (reader == nullptr) {
+    return 1;
+  }
+
+  std::unordered_map<uint32_t, float> temperature_by_attempt;
+  std::cout << "attempt,step,event,move,first,second,accepted,cost,delta,"
+               "temperature"
+            << std::endl;
+  for (uint64_t i = 0; i < reader->num_records(); i++) {
+    const anneal::TraceRecord &record = reader->record(i);
+    float &temperature = temperature_by_attempt[record.attempt];
+    std::cout << record.attempt << ',' << record.step << ','
+              << EventName(record.event) << ',' << MoveName(record.move)
+              << ',';
+    if (record.event == anneal::TraceEvent::Step) {
+      std::cout << record.first << ',' << record.second << ','
+                << (int)record.accepted << ',' << record.cost << ','
+                << record.value;
+    } else {
+      temperature = record.value;
+      std::cout << ",,," << record.cost << ',';
+    }
+    std::cout << ',' << temperature << '\n';
+  }
+  return 0;
+}
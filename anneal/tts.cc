@@ -0,0 +1,188 @@
+#include "tts.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <thread>
+
+#include <math.h>
+
+namespace anneal {
+
+// Nearest-rank percentile of sorted values.
+static double Percentile(const std::vector<double> &sorted, double fraction) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t rank = (size_t)ceil(fraction * sorted.size());
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+TtsSummary Summarize(const std::vector<RunResult> &runs, double confidence) {
+  TtsSummary summary = {};
+  summary.num_runs = runs.size();
+  summary.confidence = confidence;
+
+  std::vector<double> seconds;
+  std::vector<double> evaluations;
+  double total_seconds = 0;
+  int64_t total_attempts = 0;
+  for (const auto &run : runs) {
+    total_seconds += run.seconds;
+    total_attempts += run.attempts;
+    if (run.solved) {
+      seconds.push_back(run.seconds);
+      evaluations.push_back(run.evaluations);
+    }
+  }
+  std::sort(seconds.begin(), seconds.end());
+  std::sort(evaluations.begin(), evaluations.end());
+
+  summary.num_solved = seconds.size();
+  if (!runs.empty()) {
+    summary.success_probability = (double)summary.num_solved / runs.size();
+  }
+  summary.median_seconds = Percentile(seconds, 0.5);
+  summary.p90_seconds = Percentile(seconds, 0.9);
+  summary.p99_seconds = Percentile(seconds, 0.99);
+  summary.median_evaluations = Percentile(evaluations, 0.5);
+  summary.p90_evaluations = Percentile(evaluations, 0.9);
+  summary.p99_evaluations = Percentile(evaluations, 0.99);
+
+  if (total_attempts > 0) {
+    summary.attempt_success_probability =
+        (double)summary.num_solved / total_attempts;
+    summary.mean_attempt_seconds = total_seconds / total_attempts;
+  }
+  double p = summary.attempt_success_probability;
+  if (p <= 0) {
+    summary.expected_tts_seconds = std::numeric_limits<double>::infinity();
+  } else if (p >= 1) {
+    summary.expected_tts_seconds = summary.mean_attempt_seconds;
+  } else {
+    double attempts = ceil(log(1 - confidence) / log(1 - p));
+    summary.expected_tts_seconds =
+        std::max(attempts, 1.0) * summary.mean_attempt_seconds;
+  }
+  return summary;
+}
+
+static double MedianSeconds(const std::vector<RunResult> &runs) {
+  std::vector<double> seconds;
+  for (const auto &run : runs) {
+    seconds.push_back(run.solved ? run.seconds
+                                 : std::numeric_limits<double>::infinity());
+  }
+  std::sort(seconds.begin(), seconds.end());
+  return Percentile(seconds, 0.5);
+}
+
+TtsComparison Compare(const std::vector<RunResult> &a,
+                      const std::vector<RunResult> &b) {
+  // Rank the pooled wall times, averaging the ranks of ties. Unsolved runs
+  // count as infinitely slow and therefore tie with each other.
+  std::vector<std::pair<double, bool>> pooled;
+  for (const auto &run : a) {
+    pooled.emplace_back(
+        run.solved ? run.seconds : std::numeric_limits<double>::infinity(),
+        true);
+  }
+  for (const auto &run : b) {
+    pooled.emplace_back(
+        run.solved ? run.seconds : std::numeric_limits<double>::infinity(),
+        false);
+  }
+  std::sort(pooled.begin(), pooled.end());
+
+  double rank_sum_a = 0;
+  double tie_correction = 0;
+  for (size_t i = 0; i < pooled.size();) {
+    size_t j = i;
+    while (j < pooled.size() && pooled[j].first == pooled[i].first) {
+      j++;
+    }
+    double rank = (i + 1 + j) / 2.0;
+    for (size_t k = i; k < j; k++) {
+      if (pooled[k].second) {
+        rank_sum_a += rank;
+      }
+    }
+    double ties = j - i;
+    tie_correction += ties * ties * ties - ties;
+    i = j;
+  }
+
+  double n_a = a.size();
+  double n_b = b.size();
+  double n = n_a + n_b;
+  TtsComparison comparison = {};
+  comparison.u_statistic = rank_sum_a - n_a * (n_a + 1) / 2;
+  double mean = n_a * n_b / 2;
+  double variance =
+      n > 1 ? n_a * n_b / 12 * ((n + 1) - tie_correction / (n * (n - 1)))
+            : 0;
+  if (variance > 0) {
+    comparison.z = (comparison.u_statistic - mean) / sqrt(variance);
+    comparison.p_value = erfc(fabs(comparison.z) / sqrt(2.0));
+  } else {
+    comparison.p_value = 1;
+  }
+  comparison.median_ratio = MedianSeconds(a) / MedianSeconds(b);
+  return comparison;
+}
+
+std::vector<RunResult> RunTrials(
+    const std::function<RunResult(uint64_t seed)> &run, uint64_t base_seed,
+    size_t num_runs, int num_threads) {
+  std::vector<RunResult> results(num_runs);
+  std::atomic<size_t> next_run(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < std::max(num_threads, 1); i++) {
+    threads.emplace_back([&]() {
+      for (size_t index = next_run++; index < num_runs; index = next_run++) {
+        results[index] = run(base_seed + index);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return results;
+}
+
+// JSON has no infinity; unbounded values are written as null.
+static std::ostream &WriteNumber(std::ostream &os, double value) {
+  if (std::isinf(value) || std::isnan(value)) {
+    return os << "null";
+  }
+  return os << value;
+}
+
+std::ostream &WriteJson(std::ostream &os, const TtsSummary &summary) {
+  os << "{\"num_runs\": " << summary.num_runs
+     << ", \"num_solved\": " << summary.num_solved
+     << ", \"success_probability\": " << summary.success_probability
+     << ", \"median_seconds\": " << summary.median_seconds
+     << ", \"p90_seconds\": " << summary.p90_seconds
+     << ", \"p99_seconds\": " << summary.p99_seconds
+     << ", \"median_evaluations\": " << summary.median_evaluations
+     << ", \"p90_evaluations\": " << summary.p90_evaluations
+     << ", \"p99_evaluations\": " << summary.p99_evaluations
+     << ", \"attempt_success_probability\": "
+     << summary.attempt_success_probability
+     << ", \"mean_attempt_seconds\": " << summary.mean_attempt_seconds
+     << ", \"confidence\": " << summary.confidence
+     << ", \"expected_tts_seconds\": ";
+  return WriteNumber(os, summary.expected_tts_seconds) << "}";
+}
+
+std::ostream &WriteJson(std::ostream &os, const TtsComparison &comparison) {
+  os << "{\"median_ratio\": ";
+  WriteNumber(os, comparison.median_ratio)
+      << ", \"u_statistic\": " << comparison.u_statistic
+      << ", \"z\": " << comparison.z << ", \"p_value\": "
+      << comparison.p_value;
+  return os << "}";
+}
+
+}  // namespace anneal
@@ -0,0 +1,72 @@
+#ifndef ANNEAL_TTS_H_
+#define ANNEAL_TTS_H_
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace anneal {
+
+// Outcome of one run: attempts from a single seed until one solves the board
+// or the run gives up.
+struct RunResult {
+  bool solved;
+  double seconds;
+  uint64_t evaluations;
+  int64_t attempts;
+};
+
+// Time-to-solution statistics over many runs. Solvers are stochastic and
+// their run times heavy-tailed, so medians and tail percentiles are
+// reported rather than means.
+struct TtsSummary {
+  size_t num_runs;
+  size_t num_solved;
+  double success_probability;
+
+  // Percentiles over the solved runs; zero if none solved.
+  double median_seconds;
+  double p90_seconds;
+  double p99_seconds;
+  double median_evaluations;
+  double p90_evaluations;
+  double p99_evaluations;
+
+  // Per-attempt view, used for the expected time to solution: the time
+  // needed to find a solution with probability `confidence` by running
+  // independent attempts, ceil(log(1 - confidence) / log(1 - p)) * t.
+  double attempt_success_probability;
+  double mean_attempt_seconds;
+  double confidence;
+  double expected_tts_seconds;  // Infinity if nothing was solved.
+};
+
+TtsSummary Summarize(const std::vector<RunResult> &runs, double confidence);
+
+// Mann-Whitney U test on the wall times of two sets of runs, with unsolved
+// runs ranked after every solved one. A negative z means `a` is faster.
+struct TtsComparison {
+  double median_ratio;  // median seconds of a over that of b
+  double u_statistic;
+  double z;
+  double p_value;  // two-sided, normal approximation
+};
+
+TtsComparison Compare(const std::vector<RunResult> &a,
+                      const std::vector<RunResult> &b);
+
+// Runs run(base_seed + i) for i in [0, num_runs) on num_threads threads.
+std::vector<RunResult> RunTrials(
+    const std::function<RunResult(uint64_t seed)> &run, uint64_t base_seed,
+    size_t num_runs, int num_threads);
+
+std::ostream &WriteJson(std::ostream &os, const TtsSummary &summary);
+std::ostream &WriteJson(std::ostream &os, const TtsComparison &comparison);
+
+}  // namespace anneal
+
+#endif  // ANNEAL_TTS_H_
@@ -0,0 +1,78 @@
+#include "tts.h"
+#include "gtest/gtest.h"
+
+#include <math.h>
+
+using anneal::RunResult;
+
+static std::vector<RunResult> Solved(std::vector<double> seconds) {
+  std::vector<RunResult> runs;
+  for (double s : seconds) {
+    runs.push_back(RunResult{true, s, (uint64_t)(s * 100), 1});
+  }
+  return runs;
+}
+
+TEST(TtsTest, Percentiles) {
+  std::vector<double> seconds;
+  for (int i = 1; i <= 100; i++) {
+    seconds.push_back(i);
+  }
+  anneal::TtsSummary summary = anneal::Summarize(Solved(seconds), 0.99);
+  EXPECT_EQ(100UL, summary.num_solved);
+  EXPECT_DOUBLE_EQ(1.0, summary.success_probability);
+  EXPECT_DOUBLE_EQ(50, summary.median_seconds);
+  EXPECT_DOUBLE_EQ(90, summary.p90_seconds);
+  EXPECT_DOUBLE_EQ(99, summary.p99_seconds);
+  EXPECT_DOUBLE_EQ(5000, summary.median_evaluations);
+}
+
+TEST(TtsTest, ExpectedTimeToSolution) {
+  // One solution in four attempts of one second each: p = 0.25, and
+  // ceil(log(0.01) / log(0.75)) = 17 attempts are needed for 99%.
+  std::vector<RunResult> runs = {RunResult{true, 2, 0, 2},
+                                 RunResult{false, 2, 0, 2}};
+  anneal::TtsSummary summary = anneal::Summarize(runs, 0.99);
+  EXPECT_DOUBLE_EQ(0.5, summary.success_probability);
+  EXPECT_DOUBLE_EQ(0.25, summary.attempt_success_probability);
+  EXPECT_DOUBLE_EQ(1.0, summary.mean_attempt_seconds);
+  EXPECT_DOUBLE_EQ(17.0, summary.expected_tts_seconds);
+}
+
+TEST(TtsTest, NothingSolved) {
+  std::vector<RunResult> runs = {RunResult{false, 1, 10, 3}};
+  anneal::TtsSummary summary = anneal::Summarize(runs, 0.99);
+  EXPECT_EQ(0UL, summary.num_solved);
+  EXPECT_TRUE(std::isinf(summary.expected_tts_seconds));
+}
+
+TEST(TtsTest, CompareFasterConfiguration) {
+  std::vector<double> fast, slow;
+  for (int i = 0; i < 50; i++) {
+    fast.push_back(1 + i * 0.01);
+    slow.push_back(2 + i * 0.01);
+  }
+  anneal::TtsComparison comparison =
+      anneal::Compare(Solved(fast), Solved(slow));
+  EXPECT_DOUBLE_EQ(0, comparison.u_statistic);
+  EXPECT_LT(comparison.z, 0);
+  EXPECT_LT(comparison.p_value, 1e-6);
+  EXPECT_LT(comparison.median_ratio, 1);
+}
+
+TEST(TtsTest, CompareIdentical) {
+  std::vector<RunResult> runs = Solved({1, 2, 3, 4});
+  anneal::TtsComparison comparison = anneal::Compare(runs, runs);
+  EXPECT_DOUBLE_EQ(0, comparison.z);
+  EXPECT_DOUBLE_EQ(1, comparison.p_value);
+}
+
+TEST(TtsTest, RunTrialsUsesConsecutiveSeeds) {
+  auto runs = anneal::RunTrials(
+      [](uint64_t seed) { return RunResult{seed % 2 == 0, 0, seed, 1}; }, 10,
+      5, 3);
+  ASSERT_EQ(5UL, runs.size());
+  for (size_t i = 0; i < runs.size(); i++) {
+    EXPECT_EQ(10 + i, runs[i].evaluations);
+  }
+}
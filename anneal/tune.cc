@@ -0,0 +1,232 @@
+#include "tune.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+#include <math.h>
+
+#include "rng.h"
+
+namespace anneal {
+
+namespace {
+
+struct Candidate {
+  SolverConfig config;
+  std::vector<RunResult> attempts;
+  uint64_t next_seed;
+  double score;
+};
+
+double SecondsSince(std::chrono::steady_clock::time_point begin) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       begin)
+      .count();
+}
+
+// Configurations around `initial`, which is always the first one. Each
+// parameter is scaled by a power of two (t_min by a power of ten, so that
+// the schedules cover a wide range of final temperatures), and either
+// schedule is picked.
+std::vector<SolverConfig> SampleCandidates(const SolverConfig &initial,
+                                           size_t num_candidates,
+                                           uint64_t seed) {
+  static const double kScales[] = {0.25, 0.5, 1, 2, 4};
+  static const double kTemperatureScales[] = {0.01, 0.1, 1, 10, 100};
+  std::vector<SolverConfig> configs = {initial};
+  Rng rng(seed, 0);
+  for (size_t tries = 0; configs.size() < num_candidates && tries < 1000;
+       tries++) {
+    SolverConfig config;
+    config.max_tries = std::max<int64_t>(
+        1, llround(initial.max_tries * kScales[rng.Below(5)]));
+    config.annealing_steps = std::max<int32_t>(
+        1, lround(initial.annealing_steps * kScales[rng.Below(5)]));
+    config.t_max = initial.t_max * kScales[rng.Below(5)];
+    config.t_min = initial.t_min * kTemperatureScales[rng.Below(5)];
+    config.schedule =
+        rng.Bit() ? ScheduleKind::Adaptive : ScheduleKind::Geometric;
+    config.max_reheats = initial.max_reheats;
+    if (config.t_min >= config.t_max) {
+      continue;
+    }
+    bool duplicate = false;
+    for (const auto &other : configs) {
+      duplicate |= config.ToString() == other.ToString();
+    }
+    if (!duplicate) {
+      configs.push_back(config);
+    }
+  }
+  return configs;
+}
+
+// Expected time to solution with the attempt success probability smoothed
+// towards zero, so that configurations that have not solved anything yet
+// still rank by how much they were given the chance to.
+double Score(const std::vector<RunResult> &attempts, double confidence) {
+  double seconds = 0;
+  size_t solved = 0;
+  for (const auto &attempt : attempts) {
+    seconds += attempt.seconds;
+    solved += attempt.solved;
+  }
+  if (attempts.empty()) {
+    return std::numeric_limits<double>::infinity();
+  }
+  double p = (solved + 0.5) / (attempts.size() + 1);
+  double needed = p >= 1 ? 1 : ceil(log(1 - confidence) / log(1 - p));
+  return std::max(needed, 1.0) * seconds / attempts.size();
+}
+
+// Attempts per second of `config` with num_threads threads running
+// independent attempts for `seconds`.
+double Throughput(const AttemptRunner &run, const SolverConfig &config,
+                  int num_threads, double seconds, uint64_t seed) {
+  std::atomic<uint64_t> num_attempts(0);
+  auto begin = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back([&, i]() {
+      for (uint64_t n = 0; n == 0 || SecondsSince(begin) < seconds; n++) {
+        run(config, seed + ((uint64_t)i << 32) + n);
+        num_attempts++;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return num_attempts / SecondsSince(begin);
+}
+
+}  // namespace
+
+TuneResult Autotune(const AttemptRunner &run, const SolverConfig &initial,
+                    const TuneOptions &options) {
+  std::vector<Candidate> candidates;
+  uint64_t stream = 0;
+  for (const auto &config :
+       SampleCandidates(initial, options.num_candidates, options.seed)) {
+    candidates.push_back(Candidate{config, {}, options.seed + (stream++ << 32),
+                                   std::numeric_limits<double>::infinity()});
+  }
+
+  // A fifth of the budget goes to picking the thread count, if there is a
+  // choice; the rest is split evenly between the rounds.
+  double race_budget = options.budget_seconds;
+  if (options.max_threads > 1) {
+    race_budget *= 0.8;
+  }
+  size_t num_rounds = 1;
+  while ((1ULL << num_rounds) < candidates.size()) {
+    num_rounds++;
+  }
+
+  // Candidates run one at a time so that their attempt times are not
+  // distorted by each other. Each gets at least one attempt per round, but
+  // no attempt starts once the race is over budget, except the very first,
+  // so that there is always a result; the race then ends with the best
+  // candidate so far. Those that did not run yet keep their score.
+  auto start = std::chrono::steady_clock::now();
+  bool out_of_time = false;
+  for (size_t round = 0; round < num_rounds && !out_of_time; round++) {
+    double slice = race_budget / num_rounds / candidates.size();
+    for (auto &candidate : candidates) {
+      auto begin = std::chrono::steady_clock::now();
+      size_t num_run = 0;
+      while (num_run == 0 || SecondsSince(begin) < slice) {
+        if (SecondsSince(start) >= race_budget &&
+            !candidates[0].attempts.empty()) {
+          out_of_time = true;
+          break;
+        }
+        candidate.attempts.push_back(
+            run(candidate.config, candidate.next_seed++));
+        num_run++;
+      }
+      if (num_run > 0) {
+        candidate.score = Score(candidate.attempts, options.confidence);
+      }
+      if (out_of_time) {
+        break;
+      }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Candidate &a, const Candidate &b) {
+                       return a.score < b.score;
+                     });
+    if (options.log != nullptr) {
+      *options.log << "Round " << round << ": " << candidates.size()
+                   << " candidates, best " << candidates[0].config.ToString()
+                   << " (" << candidates[0].attempts.size()
+                   << " attempts, score " << candidates[0].score << " s)"
+                   << (out_of_time ? ", out of time" : "") << std::endl;
+    }
+    candidates.resize(std::max<size_t>(1, candidates.size() / 2));
+  }
+
+  TuneResult result;
+  result.config = candidates[0].config;
+  result.summary = Summarize(candidates[0].attempts, options.confidence);
+  result.num_threads = 1;
+  if (options.max_threads > 1) {
+    std::vector<int> thread_counts;
+    for (int n = 1; n < options.max_threads; n *= 2) {
+      thread_counts.push_back(n);
+    }
+    thread_counts.push_back(options.max_threads);
+    double slice = options.budget_seconds * 0.2 / thread_counts.size();
+    double best = 0;
+    for (int num_threads : thread_counts) {
+      // Whatever the race left of the budget; larger thread counts are
+      // skipped once it is spent.
+      double remaining = options.budget_seconds - SecondsSince(start);
+      if (remaining <= 0) {
+        break;
+      }
+      double throughput =
+          Throughput(run, result.config, num_threads,
+                     std::min(slice, remaining), candidates[0].next_seed);
+      if (options.log != nullptr) {
+        *options.log << num_threads << " threads: " << throughput
+                     << " attempts/s" << std::endl;
+      }
+      // More threads have to pay for themselves.
+      if (throughput > best * 1.05) {
+        best = throughput;
+        result.num_threads = num_threads;
+      }
+    }
+  }
+  return result;
+}
+
+bool WriteFlagFile(const std::string &path, const TuneResult &result,
+                   const std::string &comment) {
+  std::ofstream out(path);
+  out << "# " << comment << std::endl
+      << "# Expected time to solution on one thread: "
+      << result.summary.expected_tts_seconds << " s at "
+      << result.summary.confidence * 100 << "% confidence." << std::endl
+      << "--max_tries=" << result.config.max_tries << std::endl
+      << "--annealing_steps=" << result.config.annealing_steps << std::endl
+      << "--t_max=" << result.config.t_max << std::endl
+      << "--t_min=" << result.config.t_min << std::endl
+      << "--schedule=" << ScheduleKindName(result.config.schedule) << std::endl
+      << "--max_reheats=" << result.config.max_reheats << std::endl
+      << "--num_threads=" << result.num_threads << std::endl;
+  out.close();
+  if (!out) {
+    std::cerr << "Could not write " << path << std::endl;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace anneal
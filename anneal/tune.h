@@ -0,0 +1,53 @@
+#ifndef ANNEAL_TUNE_H_
+#define ANNEAL_TUNE_H_
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include "config.h"
+#include "tts.h"
+
+namespace anneal {
+
+struct TuneOptions {
+  double budget_seconds = 60;
+  // Number of configurations sampled for the first round.
+  size_t num_candidates = 32;
+  double confidence = 0.99;
+  // Largest thread count tried for the winning configuration.
+  int max_threads = 1;
+  uint64_t seed = 1;
+  // Progress is reported here if set.
+  std::ostream *log = nullptr;
+};
+
+struct TuneResult {
+  SolverConfig config;
+  int num_threads;
+  TtsSummary summary;
+};
+
+// Runs one attempt of a configuration from a given seed.
+using AttemptRunner =
+    std::function<RunResult(const SolverConfig &config, uint64_t seed)>;
+
+// Races annealing configurations by successive halving: candidates sampled
+// around `initial` get an equal share of each round's time budget, and the
+// half with the worse expected time to solution is dropped after every
+// round. The winner is then run at 1, 2, 4, ... max_threads threads and the
+// thread count with the highest attempt throughput is kept. Once the budget
+// is spent, no more attempts start and the best configuration so far wins.
+TuneResult Autotune(const AttemptRunner &run, const SolverConfig &initial,
+                    const TuneOptions &options);
+
+// Writes the result as a gflags --flagfile.
+bool WriteFlagFile(const std::string &path, const TuneResult &result,
+                   const std::string &comment);
+
+}  // namespace anneal
+
+#endif  // ANNEAL_TUNE_H_
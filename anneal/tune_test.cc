@@ -0,0 +1,95 @@
+#include "tune.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <stdlib.h>
+
+using anneal::RunResult;
+using anneal::SolverConfig;
+
+static anneal::TuneOptions Options() {
+  anneal::TuneOptions options;
+  options.budget_seconds = 0.2;
+  options.num_candidates = 16;
+  return options;
+}
+
+TEST(TuneTest, PrefersCheaperAttempts) {
+  SolverConfig initial;
+  anneal::TuneResult result = anneal::Autotune(
+      [](const SolverConfig &config, uint64_t seed) {
+        double seconds = config.max_tries * config.annealing_steps * 1e-6;
+        return RunResult{true, seconds, 1, 1};
+      },
+      initial, Options());
+  EXPECT_LT(result.config.max_tries * result.config.annealing_steps,
+            initial.max_tries * initial.annealing_steps);
+  EXPECT_EQ(1, result.num_threads);
+  EXPECT_GT(result.summary.num_solved, 0UL);
+}
+
+TEST(TuneTest, OnlyConfigurationThatSolves) {
+  SolverConfig initial;
+  initial.max_tries = 10;
+  anneal::TuneResult result = anneal::Autotune(
+      [&initial](const SolverConfig &config, uint64_t seed) {
+        bool solved = config.ToString() == initial.ToString() && seed % 3 == 0;
+        return RunResult{solved, 1e-6, 1, 1};
+      },
+      initial, Options());
+  EXPECT_EQ(initial.ToString(), result.config.ToString());
+}
+
+TEST(TuneTest, StopsWhenTheBudgetIsSpent) {
+  // Each candidate would get at least one attempt in every round, which
+  // alone takes 16 + 8 + 4 + 2 = 30 attempts, or 0.3 s.
+  anneal::TuneOptions options = Options();
+  options.budget_seconds = 0.1;
+  options.max_threads = 4;
+  auto begin = std::chrono::steady_clock::now();
+  std::atomic<size_t> num_attempts(0);
+  anneal::TuneResult result = anneal::Autotune(
+      [&num_attempts](const SolverConfig &config, uint64_t seed) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        num_attempts++;
+        return RunResult{seed % 2 == 0, 0.01, 1, 1};
+      },
+      SolverConfig(), options);
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - begin)
+                       .count();
+  // One attempt, on every thread, may still finish after the deadline.
+  EXPECT_LT(seconds, 0.1 + 0.05);
+  EXPECT_LT(num_attempts, 16U);
+  EXPECT_GT(result.summary.num_runs, 0UL);
+}
+
+TEST(TuneTest, WritesFlagFile) {
+  const char *dir = getenv("TEST_TMPDIR");
+  std::string path =
+      std::string(dir != nullptr ? dir : "/tmp") + "/tune_test.flags";
+  anneal::TuneResult result;
+  result.config.max_tries = 48;
+  result.config.annealing_steps = 100;
+  result.num_threads = 4;
+  result.summary = anneal::Summarize({RunResult{true, 0.5, 1, 1}}, 0.99);
+  ASSERT_TRUE(anneal::WriteFlagFile(path, result, "test"));
+
+  std::ifstream in(path);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  EXPECT_NE(std::string::npos, contents.str().find("--max_tries=48\n"));
+  EXPECT_NE(std::string::npos, contents.str().find("--annealing_steps=100\n"));
+  EXPECT_NE(std::string::npos, contents.str().find("--t_max=1\n"));
+  EXPECT_NE(std::string::npos, contents.str().find("--t_min=1e-05\n"));
+  EXPECT_NE(std::string::npos, contents.str().find("--num_threads=4\n"));
+  EXPECT_NE(std::string::npos,
+            contents.str().find("--schedule=geometric\n"));
+  EXPECT_FALSE(
+      anneal::WriteFlagFile("/nonexistent/dir/tune.flags", result, ""));
+}
@@ -0,0 +1,74 @@
+// Time-to-solution harness: runs a solver configuration from many seeds
+// in-process and reports success probability, wall time and evaluation
+// percentiles, and the expected time to solution at a given confidence.
+// With --baseline, a second configuration is run on the same seeds and the
+// two are compared.
+
+#include <iostream>
+#include <string>
+
+#include <gflags/gflags.h>
+
+#include "problem.h"
+#include "solver.h"
+#include "tts.h"
+
+DEFINE_string(config, "",
+              "Solver configuration to measure, as comma-separated "
+              "key=value pairs, e.g. max_tries=24,annealing_steps=200. "
+              "Unset keys keep their defaults.");
+DEFINE_string(baseline, "",
+              "Optional configuration to compare --config against, in the "
+              "same format.");
+DEFINE_int32(num_runs, 200, "Number of seeds to run each configuration on.");
+DEFINE_uint64(seed, 1, "First seed; runs use consecutive seeds.");
+DEFINE_int64(max_attempts, 64,
+             "Attempts per run before it is counted as unsolved.");
+DEFINE_double(confidence, 0.99,
+              "Confidence level of the expected time to solution.");
+DEFINE_int32(num_threads, 1,
+             "Number of runs to execute concurrently. Keep at 1 for the "
+             "most accurate wall times.");
+
+static std::vector<anneal::RunResult> Measure(
+    const atax::BoardProblem &problem, const anneal::SolverConfig &config) {
+  return anneal::RunTrials(
+      [&](uint64_t seed) {
+        return anneal::RunToSolution(problem, config, seed, FLAGS_max_attempts);
+      },
+      FLAGS_seed, FLAGS_num_runs, FLAGS_num_threads);
+}
+
+int main(int argc, char **argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  anneal::SolverConfig config;
+  if (!anneal::SolverConfig::Parse(FLAGS_config, &config)) {
+    return 1;
+  }
+  // Parsed up front, so that a bad spec fails before any measurement.
+  anneal::SolverConfig baseline;
+  if (!FLAGS_baseline.empty() &&
+      !anneal::SolverConfig::Parse(FLAGS_baseline, &baseline)) {
+    return 1;
+  }
+  atax::BoardProblem problem;
+
+  auto runs = Measure(problem, config);
+  std::cout << "{\"config\": {\"spec\": \"" << config.ToString()
+            << "\", \"summary\": ";
+  anneal::WriteJson(std::cout, anneal::Summarize(runs, FLAGS_confidence))
+      << "}";
+
+  if (!FLAGS_baseline.empty()) {
+    auto baseline_runs = Measure(problem, baseline);
+    std::cout << ", \"baseline\": {\"spec\": \"" << baseline.ToString()
+              << "\", \"summary\": ";
+    anneal::WriteJson(std::cout,
+                      anneal::Summarize(baseline_runs, FLAGS_confidence))
+        << "}, \"comparison\": ";
+    anneal::WriteJson(std::cout, anneal::Compare(runs, baseline_runs));
+  }
+  std::cout << "}" << std::endl;
+  return 0;
+}
@@ -11,6 +11,11 @@ namespace atax {
 /* static */
 Board Board::Create() { return Board(); }
 
+/* static */
+Board Board::Create(const size_t (&by_piece)[kNumPieces]) {
+  return Board(by_piece);
+}
+
 constexpr Board::Piece PIECES[Board::kNumPieces] = {
     Board::Piece::Rook,   Board::Piece::Rook,   Board::Piece::Knight,
     Board::Piece::Knight, Board::Piece::Bishop, Board::Piece::Bishop,
@@ -43,6 +48,11 @@ Board::Board() {
   FixBoard();
 }
 
+Board::Board(const size_t (&by_piece)[kNumPieces]) {
+  memcpy(by_piece_, by_piece, sizeof(by_piece_));
+  FixBoard();
+}
+
 void Board::FixBoard() {
   memset(by_square_, 0, sizeof(by_square_));
   for (size_t piece_index = 0; piece_index < kNumPieces; piece_index++) {
@@ -243,6 +253,11 @@ void Board::Permute(size_t start_piece_index, size_t end_piece_index) {
   FixBoard();
 }
 
+void Board::Restore(const size_t (&by_piece)[kNumPieces]) {
+  memcpy(by_piece_, by_piece, sizeof(by_piece_));
+  FixBoard();
+}
+
 std::vector<std::tuple<size_t, size_t, Board::Piece>> Board::OccupiedRowCols()
     const {
   std::vector<std::tuple<size_t, size_t, Board::Piece>> result;
@@ -21,19 +21,25 @@ class Board {
   using BoardFreeSquares = std::bitset<kBoardSize * kBoardSize>;
 
   static Board Create();
+  static Board Create(const size_t (&by_piece)[kNumPieces]);
 
   size_t num_unattacked() const;
 
   bool Move(size_t piece_index, size_t row, size_t col);
   void Permute(size_t start_piece, size_t end_piece);
+  // Puts every piece back on the square given by GetSquare at an earlier
+  // point.
+  void Restore(const size_t (&by_piece)[kNumPieces]);
   std::vector<std::tuple<size_t, size_t, Board::Piece>> OccupiedRowCols() const;
   Piece GetPiece(size_t row, size_t col) const;
+  size_t GetSquare(size_t piece_index) const { return by_piece_[piece_index]; }
   std::string GetFen() const;
 
   void Randomize();
 
  protected:
   Board();
+  Board(const size_t (&by_piece)[kNumPieces]);
 
  private:
   bool IsValidMove(size_t piece_index, size_t row, size_t col) const;
@@ -0,0 +1,157 @@
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "board.h"
+#include "engine.h"
+#include "problem.h"
+#include "rng.h"
+
+using atax::Board;
+
+// The board itself is always 8x8, so benchmarks are parameterized by the
+// number of random moves applied to the initial position instead. This
+// covers both the crowded first rank and spread-out placements.
+static void Placements(benchmark::internal::Benchmark *b) {
+  b->Arg(0)->Arg(4)->Arg(64);
+}
+
+static Board RandomBoard(size_t num_moves) {
+  std::mt19937 rng(num_moves);
+  std::uniform_int_distribution<size_t> row_dist(0, Board::kBoardSize - 1);
+  std::uniform_int_distribution<size_t> pieces_dist(0, Board::kNumPieces - 1);
+  Board b = Board::Create();
+  for (size_t move = 0; move < num_moves; move++) {
+    size_t piece_index = pieces_dist(rng);
+    while (!b.Move(piece_index, row_dist(rng), row_dist(rng))) {
+      /* Do nothing */
+    }
+  }
+  return b;
+}
+
+// Moves are drawn up front so that the RNG is not part of the measurement.
+// They are a chain: each is valid from the board the ones before it leave
+// behind, starting with `start`.
+static std::vector<std::tuple<size_t, size_t, size_t>> RandomMoves(
+    const Board &start) {
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<size_t> row_dist(0, Board::kBoardSize - 1);
+  std::uniform_int_distribution<size_t> pieces_dist(0, Board::kNumPieces - 1);
+  std::vector<std::tuple<size_t, size_t, size_t>> result;
+  Board b = start;
+  while (result.size() < 1024) {
+    size_t piece_index = pieces_dist(rng);
+    size_t row = row_dist(rng);
+    size_t col = row_dist(rng);
+    if (b.Move(piece_index, row, col)) {
+      result.emplace_back(piece_index, row, col);
+    }
+  }
+  return result;
+}
+
+static void BM_NumUnattacked(benchmark::State &state) {
+  Board b = RandomBoard(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(b.num_unattacked());
+  }
+}
+BENCHMARK(BM_NumUnattacked)->Apply(Placements);
+
+// Move() is dominated by FixBoard(), which rebuilds the square index after
+// every change; this is the way to measure it through the public API. The
+// chain of moves is replayed from `start`, so every move succeeds; "moved"
+// counts the moves that did, per iteration, and should be 1.
+static void BM_Move(benchmark::State &state) {
+  Board start = RandomBoard(state.range(0));
+  auto moves = RandomMoves(start);
+  Board b = start;
+  size_t index = 0;
+  uint64_t num_moved = 0;
+  for (auto _ : state) {
+    if (index == moves.size()) {
+      state.PauseTiming();
+      b = start;
+      index = 0;
+      state.ResumeTiming();
+    }
+    const auto &move = moves[index++];
+    bool moved =
+        b.Move(std::get<0>(move), std::get<1>(move), std::get<2>(move));
+    benchmark::DoNotOptimize(moved);
+    num_moved += moved;
+  }
+  state.counters["moved"] =
+      benchmark::Counter(num_moved, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Move)->Apply(Placements);
+
+static void BM_Permute(benchmark::State &state) {
+  Board b = RandomBoard(state.range(0));
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<size_t> pieces_dist(0, Board::kNumPieces - 1);
+  std::vector<std::pair<size_t, size_t>> pieces(1024);
+  for (auto &pair : pieces) {
+    pair = std::make_pair(pieces_dist(rng), pieces_dist(rng));
+  }
+  size_t index = 0;
+  for (auto _ : state) {
+    const auto &pair = pieces[index++ % pieces.size()];
+    b.Permute(pair.first, pair.second);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_Permute)->Apply(Placements);
+
+static void BM_GetFen(benchmark::State &state) {
+  Board b = RandomBoard(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(b.GetFen());
+  }
+}
+BENCHMARK(BM_GetFen)->Apply(Placements);
+
+static void BM_Copy(benchmark::State &state) {
+  Board b = RandomBoard(state.range(0));
+  for (auto _ : state) {
+    Board copy = b;
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_Copy)->Apply(Placements);
+
+static void BM_Assign(benchmark::State &state) {
+  Board b = RandomBoard(state.range(0));
+  Board other = Board::Create();
+  for (auto _ : state) {
+    other = b;
+    benchmark::DoNotOptimize(other);
+  }
+}
+BENCHMARK(BM_Assign)->Apply(Placements);
+
+// Steps of anneal::Annealer on the board policy with no observer, in one
+// stage of 1024 steps at T = 1. The policy is resolved at compile time, so a
+// step should cost no more than its parts: BM_NumUnattacked, a BM_Move or
+// BM_Permute, the randomness, and a restore for rejected moves.
+static void BM_AnnealStep(benchmark::State &state) {
+  Board start = RandomBoard(state.range(0));
+  atax::BoardProblem problem;
+  anneal::Rng rng(0, 0);
+  anneal::NullObserver observer;
+  uint64_t num_steps = 0;
+  for (auto _ : state) {
+    anneal::CoolingSchedule schedule(anneal::ScheduleKind::Geometric, 1.0,
+                                     0.5, 1, 1024, 0);
+    anneal::Annealer<atax::BoardProblem, anneal::Rng, anneal::NullObserver>
+        annealer(problem, start, &rng, &schedule, &observer);
+    annealer.Run();
+    num_steps += annealer.num_steps();
+  }
+  state.SetItemsProcessed(num_steps);
+}
+BENCHMARK(BM_AnnealStep)->Apply(Placements);
+
+BENCHMARK_MAIN();
@@ -23,6 +23,24 @@ TEST(BoardTest, Free) {
   b.Move(8, 1, 2);  // Pa2-c2
   cout << "====(Moved)====" << endl << b << endl;
 }
+
+TEST(BoardTest, RestoreUndoesMoves) {
+  Board b = Board::Create();
+  size_t by_piece[Board::kNumPieces];
+  for (size_t index = 0; index < Board::kNumPieces; index++) {
+    by_piece[index] = b.GetSquare(index);
+  }
+  size_t unattacked = b.num_unattacked();
+  b.Move(1, 7, 7);
+  b.Permute(0, 8);
+  b.Restore(by_piece);
+  for (size_t index = 0; index < Board::kNumPieces; index++) {
+    EXPECT_EQ(by_piece[index], b.GetSquare(index));
+  }
+  EXPECT_EQ(unattacked, b.num_unattacked());
+  EXPECT_EQ(b.GetFen(), Board::Create(by_piece).GetFen());
+}
+
 /*TEST(BoardTest, Copying) {
   Board b1 = Board::Create();
   Board b2 = b1;
@@ -0,0 +1,101 @@
+#ifndef ATAX_PROBLEM_H_
+#define ATAX_PROBLEM_H_
+
+#include <ostream>
+#include <string>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "board.h"
+#include "trace.h"
+
+namespace atax {
+
+// The nine pieces as a problem for anneal::Annealer and anneal::Solve. A step
+// moves a random piece to a random square it may stand on, or rotates the
+// squares of the pieces between two random pieces.
+struct BoardProblem {
+  typedef Board State;
+
+  // Permute skips pieces that may not stand on their new square, so it has no
+  // inverse; a move keeps the squares it started from instead.
+  struct Move {
+    bool permute;
+    size_t first;
+    // Square the piece moved to, or the last piece permuted.
+    size_t second;
+    size_t previous[Board::kNumPieces];
+  };
+
+  template <typename Random>
+  Move Propose(Board *b, Random *rng) const {
+    Move move;
+    for (size_t index = 0; index < Board::kNumPieces; index++) {
+      move.previous[index] = b->GetSquare(index);
+    }
+    move.permute = !rng->Bit();
+    if (!move.permute) {
+      // Draws are sequenced explicitly so that a seed gives the same
+      // trajectory whatever the compiler's argument order.
+      move.first = rng->Below(Board::kNumPieces);
+      while (true) {
+        size_t row = rng->Below(Board::kBoardSize);
+        size_t col = rng->Below(Board::kBoardSize);
+        if (b->Move(move.first, row, col)) {
+          move.second = row * Board::kBoardSize + col;
+          break;
+        }
+      }
+    } else {
+      move.first = rng->Below(Board::kNumPieces);
+      move.second = rng->Below(Board::kNumPieces);
+      b->Permute(move.first, move.second);
+    }
+    return move;
+  }
+
+  float Cost(const Board &b) const { return b.num_unattacked(); }
+
+  void Undo(Board *b, const Move &move) const { b->Restore(move.previous); }
+
+  Board Start() const { return Board::Create(); }
+
+  template <typename Random>
+  void Randomize(Board *b, Random *rng) const {
+    b->Randomize();
+  }
+
+  // A board is the square of each piece.
+  size_t num_words() const { return Board::kNumPieces; }
+
+  void Encode(const Board &b, uint32_t *words) const {
+    for (size_t index = 0; index < Board::kNumPieces; index++) {
+      words[index] = b.GetSquare(index);
+    }
+  }
+
+  Board Decode(const uint32_t *words) const {
+    size_t by_piece[Board::kNumPieces];
+    for (size_t index = 0; index < Board::kNumPieces; index++) {
+      by_piece[index] = words[index];
+    }
+    return Board::Create(by_piece);
+  }
+
+  anneal::TraceMove Kind(const Move &move) const {
+    return move.permute ? anneal::TraceMove::Permute : anneal::TraceMove::Move;
+  }
+
+  void Print(const Board &b, std::ostream &os) const {
+    os << "URL: https://lichess.org/editor/" << b.GetFen() << std::endl
+       << "Board:" << std::endl
+       << b << std::endl;
+  }
+
+  std::string Describe() const { return "atax"; }
+};
+
+}  // namespace atax
+
+#endif  // ATAX_PROBLEM_H_
@@ -0,0 +1,36 @@
+#include "problem.h"
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "rng.h"
+
+using anneal::Rng;
+using atax::Board;
+using atax::BoardProblem;
+
+TEST(BoardProblemTest, EncodeDecodeRoundTrips) {
+  BoardProblem problem;
+  Rng rng(7, 0);
+  for (int board = 0; board < 10; board++) {
+    Board b = problem.Start();
+    problem.Randomize(&b, &rng);
+    std::vector<uint32_t> words(problem.num_words());
+    problem.Encode(b, words.data());
+
+    Board decoded = problem.Decode(words.data());
+    std::vector<uint32_t> again(problem.num_words());
+    problem.Encode(decoded, again.data());
+    EXPECT_EQ(words, again);
+    EXPECT_EQ(b.GetFen(), decoded.GetFen());
+    EXPECT_EQ(problem.Cost(b), problem.Cost(decoded));
+
+    // The decoded board keeps track of what is attacked like the original.
+    Rng original_rng(9, board), decoded_rng(9, board);
+    for (int step = 0; step < 100; step++) {
+      problem.Propose(&b, &original_rng);
+      problem.Propose(&decoded, &decoded_rng);
+      EXPECT_EQ(problem.Cost(b), problem.Cost(decoded));
+    }
+  }
+}
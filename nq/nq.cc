@@ -1,17 +1,8 @@
-#include <atomic>
-#include <chrono>
-#include <iostream>
-#include <limits>
-#include <mutex>
-#include <random>
-#include <thread>
-
 #include <gflags/gflags.h>
-#include <math.h>
-#include <signal.h>
-#include <time.h>
 
-#include "queens.h"
+#include "config.h"
+#include "driver.h"
+#include "problem.h"
 
 DEFINE_int32(board_size, 8, "Number of rows/columns in the chess boards.");
 DEFINE_int32(num_threads, 32, "Number of threads to try to solve with.");
@@ -20,165 +11,87 @@ DEFINE_int64(max_tries, 24,
              "Number of random tries within an annealing iteration.");
 DEFINE_int32(annealing_steps, 200,
              "Maximum number of annealing steps run in each solution attempt");
+DEFINE_double(t_max, 1.0, "Temperature of the first annealing step.");
+DEFINE_double(t_min, 0.00001, "Temperature below which an attempt gives up.");
+DEFINE_string(schedule, "geometric",
+              "Cooling schedule: 'geometric', or 'adaptive' to size stages by "
+              "acceptance ratio and cost variance and reheat on plateaus.");
+DEFINE_int32(max_reheats, 4,
+             "Number of times an attempt may reheat with --schedule=adaptive.");
 DEFINE_int32(
     stats_interval_seconds, 10,
     "Interval between reporting stats, in seconds. No reporting if <= 0");
-
-static const double T_max = 1.0;
-static const double T_min = 0.00001;
-
-class Stats {
- public:
-  Stats()
-      : start_(clock()),
-        num_accepted_(0),
-        num_rejected_(0),
-        min_cost_(std::numeric_limits<short>::max()) {}
-
-  void UpdateAccepted(size_t delta_accepted) {
-    std::atomic_fetch_add(&num_accepted_, delta_accepted);
-  }
-
-  void UpdateRejected(size_t delta_rejected) {
-    std::atomic_fetch_add(&num_rejected_, delta_rejected);
-  }
-
-  void UpdateMinCost(size_t min_cost) {
-    if (min_cost < min_cost_) {
-      std::lock_guard<std::mutex> lock(mutex_);
-      min_cost_ = std::min(min_cost, min_cost_);
-    }
-  }
-
-  size_t GetAccepted() const { return num_accepted_; }
-  size_t GetRejected() const { return num_rejected_; }
-  float GetElapsedSeconds() const {
-    return (float)(clock() - start_) / CLOCKS_PER_SEC;
-  }
-
-  std::ostream &Dump(std::ostream &os) {
-    return os << "Elapsed time:     " << GetElapsedSeconds() << " (s)"
-              << std::endl
-              << "Rejected configs: " << GetRejected() << std::endl
-              << "Accepted configs: " << GetAccepted() << std::endl
-              << "Min cost:         " << min_cost_ << std::endl;
-  }
-
- private:
-  clock_t start_;
-  std::mutex mutex_;
-  std::atomic<size_t> num_accepted_;
-  std::atomic<size_t> num_rejected_;
-  size_t min_cost_;
-};
-
-volatile bool solved = false;
-volatile bool interrupted = false;
-
-static void handle_signal(int signum) { solved = interrupted = true; }
-
-static void solve(const nq::Queens &start, const double alpha,
-                  const int64_t max_tries, Stats *stats, volatile bool *found) {
-  nq::Queens q = start;
-  q.Randomize();
-
-  std::mt19937 rng(clock() +
-                   std::hash<std::thread::id>()(std::this_thread::get_id()));
-  std::uniform_int_distribution<int> method_dist(0, 1);
-  std::uniform_int_distribution<size_t> row_dist(0, q.num_rows() - 1);
-  std::uniform_real_distribution<> accept_dist(0, 1);
-
-  nq::Queens old_q = q;
-  float old_cost = old_q.num_attacks();
-  float min_cost = old_cost;
-  size_t num_steps = 0;
-
-  size_t accepted = 0;
-  size_t rejected = 0;
-  for (float T = T_max; T > T_min && !*found; T = T * alpha) {
-    for (int iteration = 0; iteration < max_tries && !*found; iteration++) {
-      num_steps++;
-      size_t first_row = row_dist(rng);
-      size_t second_row = row_dist(rng);
-      if (method_dist(rng) > 0) {
-        q.Permute(first_row, second_row);
-      } else {
-        q.Swap(first_row, second_row);
-      }
-
-      float new_cost = q.num_attacks();
-      if (new_cost == 0 && !*found) {
-        *found = true;
-        std::cout << "Solved at step #" << num_steps << ", temperature " << T
-                  << std::endl
-                  << "Board:" << std::endl
-                  << q << std::endl;
-      }
-
-      if (old_cost >= new_cost ||
-          exp((old_cost - new_cost) / T) > accept_dist(rng)) {
-        accepted++;
-        old_q = q;
-        old_cost = new_cost;
-        min_cost = std::min(min_cost, old_cost);
-      } else {
-        rejected++;
-        q = old_q;
-      }
-    }
-    stats->UpdateAccepted(accepted);
-    stats->UpdateRejected(rejected);
-    stats->UpdateMinCost(min_cost);
-    accepted = rejected = 0;
-  }
-  stats->UpdateAccepted(accepted);
-  stats->UpdateRejected(rejected);
-  stats->UpdateMinCost(min_cost);
-}
+DEFINE_bool(perf_counters, false,
+            "Also collect hardware counters per solver phase. Only has an "
+            "effect in builds with --define profile=1.");
+DEFINE_uint64(seed, 0,
+              "Seed for the per-attempt random number generators. A seed is "
+              "picked (and printed) if 0.");
+DEFINE_string(checkpoint_file, "",
+              "File to periodically checkpoint solver state to. No "
+              "checkpointing if empty.");
+DEFINE_int32(checkpoint_interval_seconds, 60,
+             "Interval between checkpoints, in seconds.");
+DEFINE_bool(resume, false,
+            "Resume from --checkpoint_file instead of starting afresh.");
+DEFINE_string(serve, "",
+              "Coordinate a run spread over worker processes: hand out "
+              "attempts to the workers connecting to this address, host:port "
+              "for TCP (':port' for every interface) or a Unix socket path.");
+DEFINE_string(coordinator, "",
+              "Run as a worker of the coordinator listening on this address, "
+              "host:port or a Unix socket path.");
+DEFINE_string(shm_name, "/nq",
+              "Shared memory segment through which the processes of a --serve "
+              "run on the same host stop each other. Two runs on a host need "
+              "different names.");
+DEFINE_int64(lease_size, 64,
+             "Number of attempts --serve hands to a worker at a time.");
+DEFINE_string(trace_file, "",
+              "Record every stage and step of every attempt to this file, "
+              "for trace_to_csv. No tracing if empty.");
+DEFINE_bool(pin_threads, false,
+            "Pin each solver thread to its own core, spreading threads over "
+            "sockets, and keep stats per socket.");
+DEFINE_bool(autotune, false,
+            "Instead of solving, race annealing parameters against each other "
+            "and write the fastest to --autotune_output.");
+DEFINE_double(autotune_budget_seconds, 60, "Time budget of --autotune.");
+DEFINE_int32(autotune_candidates, 32,
+             "Number of configurations --autotune starts with.");
+DEFINE_string(autotune_output, "tuned.flags",
+              "Flag file written by --autotune, for use with --flagfile.");
 
 int main(int argc, char **argv) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
-  float alpha = exp(log(T_min / T_max) / FLAGS_annealing_steps);
-
-  nq::Queens q = nq::Queens::Create(FLAGS_board_size);
-
-  int64_t remaining_tries = FLAGS_num_attempts;
-
-  signal(SIGINT, &handle_signal);
-  Stats stats;
-
-  if (FLAGS_stats_interval_seconds > 0) {
-    std::thread([&stats]() {
-      while (true) {
-        std::this_thread::sleep_for(
-            std::chrono::seconds(FLAGS_stats_interval_seconds));
-        if (solved) {
-          break;
-        }
-        stats.Dump(std::cout) << std::endl;
-      }
-    }).detach();
-  }
-
-  while (remaining_tries > 0 && !solved) {
-    int32_t num_threads = (FLAGS_num_threads <= remaining_tries)
-                              ? FLAGS_num_threads
-                              : remaining_tries;
-    std::cout << "Remaining tries: " << remaining_tries << " ... Starting "
-              << num_threads << " attempts." << std::endl;
-
-    std::vector<std::thread> threads;
-    for (int i = 0; i < num_threads; i++) {
-      threads.emplace_back(solve, q, alpha, FLAGS_max_tries, &stats, &solved);
-    }
-
-    for (auto &thread : threads) {
-      thread.join();
-    }
-    remaining_tries -= num_threads;
+  anneal::SolverConfig config;
+  config.max_tries = FLAGS_max_tries;
+  config.annealing_steps = FLAGS_annealing_steps;
+  config.t_max = FLAGS_t_max;
+  config.t_min = FLAGS_t_min;
+  config.max_reheats = FLAGS_max_reheats;
+  if (!anneal::ParseScheduleKind(FLAGS_schedule, &config.schedule)) {
+    return 1;
   }
 
-  stats.Dump(std::cout);
-
-  return solved ? 0 : 1;
+  anneal::RunOptions options;
+  options.num_threads = FLAGS_num_threads;
+  options.num_attempts = FLAGS_num_attempts;
+  options.stats_interval_seconds = FLAGS_stats_interval_seconds;
+  options.perf_counters = FLAGS_perf_counters;
+  options.seed = FLAGS_seed;
+  options.checkpoint_file = FLAGS_checkpoint_file;
+  options.checkpoint_interval_seconds = FLAGS_checkpoint_interval_seconds;
+  options.resume = FLAGS_resume;
+  options.serve = FLAGS_serve;
+  options.coordinator = FLAGS_coordinator;
+  options.shm_name = FLAGS_shm_name;
+  options.lease_size = FLAGS_lease_size;
+  options.trace_file = FLAGS_trace_file;
+  options.pin_threads = FLAGS_pin_threads;
+  options.autotune = FLAGS_autotune;
+  options.autotune_budget_seconds = FLAGS_autotune_budget_seconds;
+  options.autotune_candidates = FLAGS_autotune_candidates;
+  options.autotune_output = FLAGS_autotune_output;
+  return anneal::Run(nq::QueensProblem(FLAGS_board_size), config, options);
 }
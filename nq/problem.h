@@ -0,0 +1,94 @@
+#ifndef NQ_PROBLEM_H_
+#define NQ_PROBLEM_H_
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "queens.h"
+#include "trace.h"
+
+namespace nq {
+
+// N queens as a problem for anneal::Annealer and anneal::Solve. A step swaps
+// the columns of two random rows, or rotates the columns of the rows between
+// them.
+class QueensProblem {
+ public:
+  typedef Queens State;
+
+  struct Move {
+    // Rows of the move.
+    size_t first;
+    size_t second;
+    bool permute;
+  };
+
+  explicit QueensProblem(size_t num_rows) : num_rows_(num_rows) {}
+
+  template <typename Random>
+  Move Propose(Queens *q, Random *rng) const {
+    Move move;
+    move.first = rng->Below(q->num_rows());
+    move.second = rng->Below(q->num_rows());
+    move.permute = rng->Bit();
+    if (move.permute) {
+      q->Permute(move.first, move.second);
+    } else {
+      q->Swap(move.first, move.second);
+    }
+    return move;
+  }
+
+  float Cost(const Queens &q) const { return q.num_attacks(); }
+
+  void Undo(Queens *q, const Move &move) const {
+    if (move.permute) {
+      q->Unpermute(move.first, move.second);
+    } else {
+      q->Swap(move.first, move.second);
+    }
+  }
+
+  Queens Start() const { return Queens::Create(num_rows_); }
+
+  template <typename Random>
+  void Randomize(Queens *q, Random *rng) const {
+    q->Randomize(*rng);
+  }
+
+  // A board is the column of each row.
+  size_t num_words() const { return num_rows_; }
+
+  void Encode(const Queens &q, uint32_t *words) const {
+    for (size_t row = 0; row < num_rows_; row++) {
+      words[row] = q.col(row);
+    }
+  }
+
+  Queens Decode(const uint32_t *words) const {
+    return Queens::Create(std::vector<size_t>(words, words + num_rows_));
+  }
+
+  anneal::TraceMove Kind(const Move &move) const {
+    return move.permute ? anneal::TraceMove::Permute : anneal::TraceMove::Swap;
+  }
+
+  void Print(const Queens &q, std::ostream &os) const {
+    os << "Board:" << std::endl << q << std::endl;
+  }
+
+  std::string Describe() const {
+    return "board_size=" + std::to_string(num_rows_);
+  }
+
+ private:
+  size_t num_rows_;
+};
+
+}  // namespace nq
+
+#endif  // NQ_PROBLEM_H_
@@ -0,0 +1,35 @@
+#include "problem.h"
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "rng.h"
+
+using anneal::Rng;
+using nq::Queens;
+using nq::QueensProblem;
+
+TEST(QueensProblemTest, EncodeDecodeRoundTrips) {
+  for (size_t num_rows : {1, 8, 33}) {
+    QueensProblem problem(num_rows);
+    Rng rng(7, num_rows);
+    Queens q = problem.Start();
+    problem.Randomize(&q, &rng);
+    std::vector<uint32_t> words(problem.num_words());
+    problem.Encode(q, words.data());
+
+    Queens decoded = problem.Decode(words.data());
+    std::vector<uint32_t> again(problem.num_words());
+    problem.Encode(decoded, again.data());
+    EXPECT_EQ(words, again);
+    EXPECT_EQ(problem.Cost(q), problem.Cost(decoded));
+
+    // The decoded board keeps track of its attacks like the original.
+    Rng original_rng(9, 0), decoded_rng(9, 0);
+    for (int step = 0; step < 100; step++) {
+      problem.Propose(&q, &original_rng);
+      problem.Propose(&decoded, &decoded_rng);
+      EXPECT_EQ(problem.Cost(q), problem.Cost(decoded));
+    }
+  }
+}
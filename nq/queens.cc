@@ -7,12 +7,20 @@ namespace nq {
 /* static */
 Queens Queens::Create(size_t num_rows) { return Queens(num_rows); }
 
+/* static */
+Queens Queens::Create(const std::vector<size_t> &col_by_row) {
+  return Queens(col_by_row);
+}
+
 Queens::Queens(size_t num_rows) : num_rows_(num_rows), col_by_row_(num_rows) {
   for (size_t row = 0; row < num_rows_; row++) {
     col_by_row_[row] = row;
   }
 }
 
+Queens::Queens(const std::vector<size_t> &col_by_row)
+    : num_rows_(col_by_row.size()), col_by_row_(col_by_row) {}
+
 size_t Queens::num_attacks() const {
   size_t result = 0;
 
@@ -50,6 +58,17 @@ void Queens::Permute(size_t start_row, size_t end_row) {
   }
 }
 
+void Queens::Unpermute(size_t start_row, size_t end_row) {
+  size_t min_row = std::min(start_row, end_row);
+  size_t max_row = std::max(start_row, end_row);
+  size_t last_col = col_by_row_[max_row];
+
+  for (size_t row = max_row; row > min_row; --row) {
+    col_by_row_[row] = col_by_row_[row - 1];
+  }
+  col_by_row_[min_row] = last_col;
+}
+
 std::vector<std::pair<size_t, size_t>> Queens::OccupiedRowCols() const {
   std::vector<std::pair<size_t, size_t>> result;
   ;
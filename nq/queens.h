@@ -1,6 +1,7 @@
 #ifndef NQ_QUEENS_H_
 #define NQ_QUEENS_H_
 
+#include <algorithm>
 #include <ostream>
 #include <vector>
 
@@ -11,18 +12,29 @@ namespace nq {
 class Queens {
  public:
   static Queens Create(size_t num_rows);
+  static Queens Create(const std::vector<size_t> &col_by_row);
 
   size_t num_rows() const { return num_rows_; }
+  size_t col(size_t row) const { return col_by_row_[row]; }
   size_t num_attacks() const;
   std::vector<std::pair<size_t, size_t>> OccupiedRowCols() const;
 
   void Swap(size_t row1, size_t row2);
   void Permute(size_t start_row, size_t end_row);
+  // Undoes Permute(start_row, end_row).
+  void Unpermute(size_t start_row, size_t end_row);
 
   void Randomize();
+  // Shuffles the queens with a caller-provided generator, for reproducible
+  // runs.
+  template <typename URBG>
+  void Randomize(URBG &&rng) {
+    std::shuffle(col_by_row_.begin(), col_by_row_.end(), rng);
+  }
 
  protected:
   Queens(size_t num_rows);
+  Queens(const std::vector<size_t> &col_by_row);
 
  private:
   size_t num_rows_;
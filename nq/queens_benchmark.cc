@@ -0,0 +1,140 @@
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <math.h>
+
+#include "benchmark/benchmark.h"
+#include "engine.h"
+#include "problem.h"
+#include "queens.h"
+#include "rng.h"
+
+using nq::Queens;
+
+// Board sizes covered by every benchmark: 8, 16, ..., 1024 rows.
+static void BoardSizes(benchmark::internal::Benchmark *b) {
+  b->RangeMultiplier(2)->Range(8, 1024);
+}
+
+static Queens RandomQueens(size_t num_rows) {
+  srand(num_rows);
+  Queens q = Queens::Create(num_rows);
+  q.Randomize();
+  return q;
+}
+
+// Row pairs are drawn up front so that the RNG is not part of the
+// measurement.
+static std::vector<std::pair<size_t, size_t>> RandomRowPairs(size_t num_rows) {
+  std::mt19937 rng(num_rows);
+  std::uniform_int_distribution<size_t> row_dist(0, num_rows - 1);
+  std::vector<std::pair<size_t, size_t>> result(1024);
+  for (auto &rows : result) {
+    rows = std::make_pair(row_dist(rng), row_dist(rng));
+  }
+  return result;
+}
+
+static void BM_NumAttacks(benchmark::State &state) {
+  Queens q = RandomQueens(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(q.num_attacks());
+  }
+}
+BENCHMARK(BM_NumAttacks)->Apply(BoardSizes);
+
+static void BM_Swap(benchmark::State &state) {
+  Queens q = RandomQueens(state.range(0));
+  auto rows = RandomRowPairs(state.range(0));
+  size_t index = 0;
+  for (auto _ : state) {
+    const auto &pair = rows[index++ % rows.size()];
+    q.Swap(pair.first, pair.second);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_Swap)->Apply(BoardSizes);
+
+static void BM_Permute(benchmark::State &state) {
+  Queens q = RandomQueens(state.range(0));
+  auto rows = RandomRowPairs(state.range(0));
+  size_t index = 0;
+  for (auto _ : state) {
+    const auto &pair = rows[index++ % rows.size()];
+    q.Permute(pair.first, pair.second);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_Permute)->Apply(BoardSizes);
+
+static void BM_Copy(benchmark::State &state) {
+  Queens q = RandomQueens(state.range(0));
+  for (auto _ : state) {
+    Queens copy = q;
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_Copy)->Apply(BoardSizes);
+
+static void BM_Assign(benchmark::State &state) {
+  Queens q = RandomQueens(state.range(0));
+  Queens other = RandomQueens(state.range(0));
+  for (auto _ : state) {
+    other = q;
+    benchmark::DoNotOptimize(other);
+  }
+}
+BENCHMARK(BM_Assign)->Apply(BoardSizes);
+
+// Random draws made by one solver step: two rows, a move type and an
+// acceptance test for a cost increase of 2 at temperature 0.5.
+static void BM_StepRandomnessMt19937(benchmark::State &state) {
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int> method_dist(0, 1);
+  std::uniform_int_distribution<size_t> row_dist(0, state.range(0) - 1);
+  std::uniform_real_distribution<> accept_dist(0, 1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(row_dist(rng) + row_dist(rng));
+    benchmark::DoNotOptimize(method_dist(rng));
+    benchmark::DoNotOptimize(exp(-2 / 0.5) > accept_dist(rng));
+  }
+}
+BENCHMARK(BM_StepRandomnessMt19937)->Arg(64);
+
+static void BM_StepRandomnessRng(benchmark::State &state) {
+  anneal::Rng rng(0, 0);
+  anneal::AcceptanceTable acceptance;
+  acceptance.SetTemperature(0.5);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(rng.Below(state.range(0)) +
+                             rng.Below(state.range(0)));
+    benchmark::DoNotOptimize(rng.Bit());
+    benchmark::DoNotOptimize(acceptance.Probability(2) > rng.Uniform());
+  }
+}
+BENCHMARK(BM_StepRandomnessRng)->Arg(64);
+
+// Steps of anneal::Annealer on the N-queens policy with no observer, in one
+// stage of 1024 steps at T = 1. The policy is resolved at compile time, so a
+// step should cost no more than its parts: BM_NumAttacks, a BM_Swap or
+// BM_Permute, the randomness, and an undo for rejected moves.
+static void BM_AnnealStep(benchmark::State &state) {
+  Queens start = RandomQueens(state.range(0));
+  nq::QueensProblem problem(state.range(0));
+  anneal::Rng rng(0, 0);
+  anneal::NullObserver observer;
+  uint64_t num_steps = 0;
+  for (auto _ : state) {
+    anneal::CoolingSchedule schedule(anneal::ScheduleKind::Geometric, 1.0,
+                                     0.5, 1, 1024, 0);
+    anneal::Annealer<nq::QueensProblem, anneal::Rng, anneal::NullObserver>
+        annealer(problem, start, &rng, &schedule, &observer);
+    annealer.Run();
+    num_steps += annealer.num_steps();
+  }
+  state.SetItemsProcessed(num_steps);
+}
+BENCHMARK(BM_AnnealStep)->Apply(BoardSizes);
+
+BENCHMARK_MAIN();
@@ -53,6 +53,15 @@ TEST(QueensTest, PermuteFour) {
   EXPECT_EQ(0UL, q.num_attacks());
 }
 
+TEST(QueensTest, UnpermuteUndoesPermute) {
+  Queens q = Queens::Create({3, 0, 4, 1, 5, 2});
+  q.Permute(4, 1);
+  q.Unpermute(4, 1);
+  for (size_t row = 0; row < 6; row++) {
+    EXPECT_EQ(Queens::Create({3, 0, 4, 1, 5, 2}).col(row), q.col(row));
+  }
+}
+
 TEST(QueensTest, Copying) {
   Queens q1 = Queens::Create(4);
   Queens q2 = q1;